@@ -76,12 +76,12 @@ namespace GradingSystemNS {
 
     // Derived class for MCQ results (inheritance)
     class MCQResult : public Result {
-        int correctAnswers;
+        double correctAnswers;   // points: MultiSelect questions can earn part of one
         int totalQuestions;
     public:
-        MCQResult(int sid, int eid, int correct, int total) 
+        MCQResult(int sid, int eid, double correct, int total) 
             : Result(sid, eid, 0, "MCQ"), correctAnswers(correct), totalQuestions(total) {
-            score = (correct * 100) / total; // Calculate percentage
+            score = total > 0 ? static_cast<int>(correct * 100 / total) : 0; // Calculate percentage
         }
 
         // Function overriding
@@ -92,7 +92,7 @@ namespace GradingSystemNS {
                  << correctAnswers << "/" << totalQuestions << ")" << endl;
         }
         
-        int getCorrectAnswers() const { return correctAnswers; }
+        double getCorrectAnswers() const { return correctAnswers; }
         int getTotalQuestions() const { return totalQuestions; }
     };
 
@@ -366,88 +366,17 @@ namespace GradingSystemNS {
                 throw GradingException("Invalid exam session provided for grading");
             }
             
-            int studentID = session->getStudentID();
-            int examID = session->getExamID();
-            
-            // Get session answer sheet
-            IAnswerSheet* sheet = session->getAnswerSheet();
-            if (!sheet) {
-                throw GradingException("No answer sheet found in session");
-            }
-            
-            // Get user answers from the answer sheet
-            map<int, string> userAnswers = sheet->getAllAnswers();
-            
-            // Get exam and questions from ExamManager
-            ExamManager* examManager = ExamManager::getInstance();
-            Exam* exam = examManager->getExam(examID);
-            if (!exam) {
-                throw GradingException("Exam not found for grading");
-            }
-            
-            // Check answers against correct answers
-            map<int, bool> results = exam->checkAnswers(userAnswers);
-            
-            // Calculate score
-            int correctCount = 0;
-            int totalQuestions = results.size();
-            
-            for (const auto& [qID, isCorrect] : results) {
-                if (isCorrect) correctCount++;
-            }
-            
-            int percentScore = totalQuestions > 0 ? (correctCount * 100) / totalQuestions : 0;
-            
-            // Create appropriate result object
-            shared_ptr<Result> result;
-            
-            // Check exam type based on first question
-            vector<shared_ptr<Question>> questions = examManager->getExamQuestions(examID);
-            bool hasMCQ = false;
-            
-            for (const auto& q : questions) {
-                if (dynamic_cast<MCQ*>(q.get())) {
-                    hasMCQ = true;
-                    break;
-                }
-            }
-            
-            if (hasMCQ) {
-                // Create MCQ result
-                result = make_shared<MCQResult>(studentID, examID, correctCount, totalQuestions);
-            } else {
-                // Create Descriptive result
-                auto descResult = make_shared<DescriptiveResult>(studentID, examID, percentScore);
-                
-                // Add detailed feedback for each question
-                for (const auto& q : questions) {
-                    int qID = q->getQuestionID();
-                    string feedback;
-                    
-                    auto answerIt = userAnswers.find(qID);
-                    if (answerIt != userAnswers.end()) {
-                        bool isCorrect = q->checkAnswer(answerIt->second);
-                        feedback = isCorrect ? 
-                            "Correct answer. Full points awarded." : 
-                            "Incorrect answer. Expected: " + q->getCorrectAnswer();
-                    } else {
-                        feedback = "No answer provided.";
-                    }
-                    
-                    descResult->addQuestionFeedback(qID, feedback);
+            try {
+                scoreExamSession(session);
+            } catch (...) {
+                // A finished sheet that failed to grade is not retried against a
+                // later version, so it must not keep an old pack alive either
+                if (session->isExamFinished() && session->getExamImage()->isOpen()) {
+                    session->releaseExamVersion();
+                    session->saveSessionToFile();
                 }
-                
-                result = descResult;
+                throw;
             }
-            
-            // Add to grading system
-            auto& gradingSystem = *GradingSystem<shared_ptr<Result>>::getInstance();
-            gradingSystem.gradeExam(result);
-            
-            // Save result to file
-            result->saveResultToFile();
-            
-            cout << "Exam graded successfully. Score: " << percentScore << "%" << endl;
         }
         
         // Function to grade all completed sessions
@@ -476,15 +405,11 @@ namespace GradingSystemNS {
         void generateAllReportCards() {
             auto& gradingSystem = *GradingSystem<shared_ptr<Result>>::getInstance();
             
-            // Collect all student IDs from results
-            set<int> allStudentIDs;
-            
-            for (auto session : SessionManager::getInstance()->getAllSessions()) {
-                allStudentIDs.insert(session->getStudentID());
-            }
+            // Every student who finished at least one exam, from the enrollment bitmaps
+            IdBitmap allStudentIDs = EnrollmentManager::getInstance()->getAllFinishedStudents();
             
             // Generate report cards
-            for (int studentID : allStudentIDs) {
+            allStudentIDs.forEach([&](int studentID) {
                 try {
                     gradingSystem.generateReportCard(studentID);
                     auto reportCard = gradingSystem.getReportCard(studentID);
@@ -493,9 +418,9 @@ namespace GradingSystemNS {
                     cerr << "Error generating report for student " << studentID 
                          << ": " << e.what() << endl;
                 }
-            }
+            });
             
-            cout << "Generated report cards for " << allStudentIDs.size() << " students." << endl;
+            cout << "Generated report cards for " << allStudentIDs.cardinality() << " students." << endl;
         }
         
         // Get a student's report card
@@ -515,20 +440,18 @@ namespace GradingSystemNS {
             // Collect all results for this exam
             vector<shared_ptr<Result>> examResults;
             
-            for (auto session : SessionManager::getInstance()->getAllSessions()) {
-                if (session->getExamID() == examID && session->isExamFinished()) {
-                    try {
-                        auto studentResults = gradingSystem.getStudentResults(session->getStudentID());
-                        for (auto& result : studentResults) {
-                            if (result->getExamID() == examID) {
-                                examResults.push_back(result);
-                            }
+            EnrollmentManager::getInstance()->getFinished(examID).forEach([&](int studentID) {
+                try {
+                    auto studentResults = gradingSystem.getStudentResults(studentID);
+                    for (auto& result : studentResults) {
+                        if (result->getExamID() == examID) {
+                            examResults.push_back(result);
                         }
-                    } catch (const exception&) {
-                        // Skip if student has no results
                     }
+                } catch (const exception&) {
+                    // Skip if student has no results
                 }
-            }
+            });
             
             if (examResults.empty()) {
                 cout << "No results found for exam ID " << examID << endl;
@@ -561,6 +484,119 @@ namespace GradingSystemNS {
             cout << "Average Score: " << averageScore << "%" << endl;
             cout << "Highest Score: " << highestScore << "%" << endl;
             cout << "Lowest Score: " << lowestScore << "%" << endl;
+            
+            // Item analysis over the finished answer sheets taken on the current version
+            try {
+                shared_ptr<const ExamImage> image = examManager->getExamImage(examID);
+                ExamStatistics statistics(image);
+                SessionManager* sessionManager = SessionManager::getInstance();
+                int otherVersions = 0;
+                EnrollmentManager::getInstance()->getFinished(examID).forEach([&](int studentID) {
+                    ExamSession* session = sessionManager->getSession(studentID, examID);
+                    if (session && session->isExamFinished() && session->getAnswerSheet()) {
+                        // Recorded version, not the image: reclaimed sessions are left out too
+                        if (session->getExamVersion() != image->getVersion()) {
+                            ++otherVersions;
+                            return;
+                        }
+                        IAnswerSheet* sheet = session->getAnswerSheet();
+                        statistics.addSheet(sheet->getAllChoices(), sheet->getAllAnswers(), session->getVariant());
+                    }
+                });
+                ExamStatistics::displayAnalysis(statistics.analyzeExam());
+                if (otherVersions > 0)
+                    cout << otherVersions << " sheet(s) taken on earlier versions of the exam are not included." << endl;
+            } catch (const ExamException& e) {
+                cout << "Item analysis unavailable: " << e.what() << endl;
+            }
+        }
+        
+    private:
+        // Scores the session and records its result; gradeExamSession handles failures
+        void scoreExamSession(ExamSession* session) {
+            int studentID = session->getStudentID();
+            int examID = session->getExamID();
+            
+            // Get session answer sheet
+            IAnswerSheet* sheet = session->getAnswerSheet();
+            if (!sheet) {
+                throw GradingException("No answer sheet found in session");
+            }
+            
+            // Get user answers from the answer sheet: MCQ option indices and text answers
+            map<int, uint8_t> userChoices = sheet->getAllChoices();
+            map<int, string> userAnswers = sheet->getAllAnswers();
+            
+            // Score against the answer key of the exam version the session was taken on
+            // (packed MCQ compare + text slots read from the mapping)
+            shared_ptr<const ExamImage> image = session->getExamImage();
+            if (session->isVersionReclaimed()) {
+                throw GradingException("Exam version " + to_string(session->getExamVersion()) +
+                                       " is no longer available for grading");
+            }
+            if (!image->isOpen()) {
+                try {
+                    image = ExamManager::getInstance()->getExamImage(examID);
+                } catch (const ExamException&) {
+                    throw GradingException("Exam not found for grading");
+                }
+            }
+            const AnswerKey& key = image->getAnswerKey();
+            double points = key.score(userChoices, userAnswers);  // MultiSelect may add partial points
+            const ExamVariant& variant = session->getVariant();
+            int totalQuestions = static_cast<int>(variant.questionCount(*image));  // the student's draw, not the pool
+            
+            int percentScore = totalQuestions > 0 ? static_cast<int>(points * 100 / totalQuestions) : 0;
+            
+            // Create appropriate result object
+            shared_ptr<Result> result;
+            
+            // Check exam type: MCQ result if anything is graded automatically
+            bool hasMCQ = key.objectiveCount() > 0;
+            
+            if (hasMCQ) {
+                // Create MCQ result
+                result = make_shared<MCQResult>(studentID, examID, points, totalQuestions);
+            } else {
+                // Create Descriptive result
+                auto descResult = make_shared<DescriptiveResult>(studentID, examID, percentScore);
+                
+                // Add detailed feedback for each question
+                for (uint32_t slot : variant.questionOrder(*image)) {
+                    ExamImage::QuestionView q = image->at(slot);
+                    int qID = q.getQuestionID();
+                    string feedback;
+                    
+                    auto answerIt = userAnswers.find(qID);
+                    if (answerIt != userAnswers.end()) {
+                        bool isCorrect = q.checkText(answerIt->second);
+                        feedback = isCorrect ? 
+                            "Correct answer. Full points awarded." : 
+                            "Incorrect answer. Expected: " + string(q.getAnswer());
+                    } else {
+                        feedback = "No answer provided.";
+                    }
+                    
+                    descResult->addQuestionFeedback(qID, feedback);
+                }
+                
+                result = descResult;
+            }
+            
+            // Add to grading system
+            auto& gradingSystem = *GradingSystem<shared_ptr<Result>>::getInstance();
+            gradingSystem.gradeExam(result);
+            
+            // Save result to file
+            result->saveResultToFile();
+            
+            // Graded: the pinned exam version is no longer needed once nothing maps it
+            if (session->getExamImage()->isOpen()) {
+                session->releaseExamVersion();
+                session->saveSessionToFile();
+            }
+            
+            cout << "Exam graded successfully. Score: " << percentScore << "%" << endl;
         }
     };
 };
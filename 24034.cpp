@@ -1,64 +1,104 @@
 #include "24034.h"
 #include <iostream>
 #include <map>
+#include <sstream>
+#include <algorithm>
+#include <cstring>
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 using namespace std;
 
 // Static members for User ID and singleton instance
 int User::nextID = 1;
 UserManager* UserManager::instance = nullptr;
 
+// Built once so repeated change checks do not allocate a path
+static const filesystem::path usersFilePath("users.json");
+static const filesystem::path usersBinPath("users.bin");
+static const filesystem::path journalPath("users.journal");
+static const filesystem::path compactingJournalPath("users.journal.compacting");
+
+// ==== ROLE HELPERS ====
+string_view roleName(Role role) {
+    switch (role) {
+        case Role::Admin: return "Admin";
+        case Role::Teacher: return "Teacher";
+        default: return "Student";
+    }
+}
+
+bool parseRole(string_view name, Role& role) {
+    if (name == "Admin") role = Role::Admin;
+    else if (name == "Teacher") role = Role::Teacher;
+    else if (name == "Student") role = Role::Student;
+    else return false;
+    return true;
+}
+
+// Unknown role strings have always become Students
+static Role roleOrStudent(string_view name) {
+    Role role = Role::Student;
+    parseRole(name, role);
+    return role;
+}
+
 // ==== USER BASE CLASS IMPLEMENTATION ====
 // Constructor: demonstrates Encapsulation
-User::User(string name, string role, string username, string password) : name(name), role(role), username(username), password(password) {
+User::User(string name, Role role, string username, string password) : role(role), name(move(name)), username(move(username)), password(move(password)) {
     userID = nextID++; // Unique ID generation using static member
 }
 
-// Polymorphic method (virtual): to be overridden by derived classes
+User::User(int id, Role role, string name, string username, string password)
+    : userID(id), role(role), name(move(name)), username(move(username)), password(move(password)) {}
+
+// Role-specific prefix comes from the role byte instead of a virtual override
 void User::displayDetails() const {
-    cout << "UserID: " << userID << ", Name: " << name << ", Role: " << role << ", Username: " << username << endl;
+    cout << "[" << roleName(role) << "] ";
+    cout << "UserID: " << userID << ", Name: " << name << ", Role: " << roleName(role) << ", Username: " << username << endl;
 }
 
 // Getter methods: Encapsulation (controlled access)
 int User::getUserID() const { 
     return userID; 
 }
-string User::getUsername() const { 
+const string& User::getUsername() const { 
     return username; 
 }
-string User::getRole() const { 
+const string& User::getName() const { 
+    return name; 
+}
+Role User::getRole() const { 
     return role; 
 }
+string_view User::getRoleName() const { 
+    return roleName(role); 
+}
 
 // Password verification: Encapsulation + Authentication
-bool User::verifyPassword(string entered) const { 
+bool User::verifyPassword(const string& entered) const { 
     return password == entered; 
 }
 
-// JSON conversion: Serialization for persistence
+// JSON conversion: Serialization for persistence (role kept as text in JSON)
 json User::toJSON() const {
-    return json{{"id", userID}, {"name", name}, {"role", role}, {"username", username}, {"password", password}};
+    return json{{"id", userID}, {"name", name}, {"role", roleName(role)}, {"username", username}, {"password", password}};
 }
 
-// JSON parsing: Deserialization + Polymorphism (dynamic role creation)
-shared_ptr<User> User::fromJSON(const json& j) {
-    string role = j.at("role");
-    shared_ptr<User> user;
-    // Inheritance: Creating derived object dynamically based on role
-    if (role == "Admin"){
-        user = make_shared<Admin>(j.at("name"), j.at("username"), j.at("password"));
-    }
-    else if (role == "Teacher"){
-        user = make_shared<Teacher>(j.at("name"), j.at("username"), j.at("password"));
-    }
-    else{
-        user = make_shared<Student>(j.at("name"), j.at("username"), j.at("password"));
-    }
+// JSON parsing: Deserialization
+User User::fromJSON(const json& j) {
+    return restore(j.at("id").get<int>(), roleOrStudent(j.at("role").get_ref<const string&>()), j.at("name").get<string>(),
+                   j.at("username").get<string>(), j.at("password").get<string>());
+}
 
-    user->userID = j.at("id");  // Restore ID
-    if (j.at("id").get<int>() >= nextID){
-        nextID = j.at("id").get<int>() + 1;  // Keep ID unique
-    }
-    return user;
+User User::restore(int id, Role role, string name, string username, string password) {
+    return User(id, role, move(name), move(username), move(password));
 }
 
 // ==== OPERATOR OVERLOADING ====
@@ -67,85 +107,631 @@ bool operator==(const User& u1, const User& u2) {
     return u1.userID == u2.userID;
 }
 
-// Stream output overload: Polymorphic output
+// Stream output overload
 ostream& operator<<(ostream& out, const User& user) {
-    out << "[" << user.userID << "] " << user.role << " - " << user.name << " (" << user.username << ")";
+    out << "[" << user.userID << "] " << roleName(user.role) << " - " << user.name << " (" << user.username << ")";
     return out;
 }
 
 // ==== DERIVED CLASSES IMPLEMENTATION ====
-// Each derived class shows Inheritance from User
-Admin::Admin(string name, string username, string password) : User(name, "Admin", username, password) {}
-void Admin::displayDetails() const {
-    cout << "[Admin] ";  // Role-specific info
-    User::displayDetails();  // Polymorphism
+// Role-fixing constructors only; objects slice to User without losing anything
+Admin::Admin(string name, string username, string password) : User(move(name), Role::Admin, move(username), move(password)) {}
+Teacher::Teacher(string name, string username, string password) : User(move(name), Role::Teacher, move(username), move(password)) {}
+Student::Student(string name, string username, string password) : User(move(name), Role::Student, move(username), move(password)) {}
+
+// ==== LIST MANAGER IMPLEMENTATION ====
+// Non-owning view: UserManager owns the users, ListManager only reads them
+
+// Display all users
+void ListManager::displayAll() const {
+    if (!items) return;
+    for (const auto& user : *items) {
+        user.displayDetails();
+    }
 }
 
-Teacher::Teacher(string name, string username, string password) : User(name, "Teacher", username, password) {}
-void Teacher::displayDetails() const {
-    cout << "[Teacher] ";
-    User::displayDetails();  // Polymorphism
+// Accessor for the viewed items
+const vector<User>& ListManager::getAllItems() const {
+    static const vector<User> empty;
+    return items ? *items : empty;
 }
 
-Student::Student(string name, string username, string password) : User(name, "Student", username, password) {}
-void Student::displayDetails() const {
-    cout << "[Student] ";
-    User::displayDetails();  // Polymorphism
+size_t ListManager::size() const {
+    return items ? items->size() : 0;
 }
 
-// ==== LIST MANAGER IMPLEMENTATION ====
-// Template class functionality for user list management (could be generalized)
+// ==== USERNAME INDEX IMPLEMENTATION ====
+// Linear probing, kept at most half full; erase uses backward-shift deletion
 
-// Composition: ListManager is used within UserManager
-void ListManager::addItem(shared_ptr<User> item) {
-    items.push_back(item);  // Aggregation: items can exist independently
+size_t UsernameIndex::findBucket(string_view username, const vector<User>& table) const {
+    if (buckets.empty()) return npos;
+    size_t mask = buckets.size() - 1;
+    for (size_t b = hash<string_view>{}(username) & mask; buckets[b] != 0; b = (b + 1) & mask) {
+        if (table[buckets[b] - 1].getUsername() == username) return b;
+    }
+    return npos;
 }
 
-void ListManager::removeItem(int id) {
-    items.erase(remove_if(items.begin(), items.end(), [id](shared_ptr<User> u) {
-        return u->getUserID() == id;
-    }), items.end());
+size_t UsernameIndex::find(string_view username, const vector<User>& table) const {
+    size_t b = findBucket(username, table);
+    return b == npos ? npos : buckets[b] - 1;
 }
 
-// Display all users (Polymorphism: calls virtual displayDetails)
-void ListManager::displayAll() const {
-    for (const auto& user : items) {
-        user->displayDetails();
+void UsernameIndex::grow(const vector<User>& table) {
+    vector<uint32_t> old = move(buckets);
+    buckets.assign(old.empty() ? 16 : old.size() * 2, 0);
+    size_t mask = buckets.size() - 1;
+    for (uint32_t entry : old) {
+        if (entry == 0) continue;
+        size_t b = hash<string_view>{}(table[entry - 1].getUsername()) & mask;
+        while (buckets[b] != 0) b = (b + 1) & mask;
+        buckets[b] = entry;
+    }
+}
+
+void UsernameIndex::reserve(size_t users, const vector<User>& table) {
+    while (buckets.size() < users * 2) grow(table);
+}
+
+void UsernameIndex::insert(size_t slot, const vector<User>& table) {
+    if ((count + 1) * 2 > buckets.size()) grow(table);
+    const string& username = table[slot].getUsername();
+    size_t mask = buckets.size() - 1;
+    size_t b = hash<string_view>{}(username) & mask;
+    for (; buckets[b] != 0; b = (b + 1) & mask) {
+        if (table[buckets[b] - 1].getUsername() == username) {
+            buckets[b] = static_cast<uint32_t>(slot + 1);  // latest user with this name wins
+            return;
+        }
+    }
+    buckets[b] = static_cast<uint32_t>(slot + 1);
+    ++count;
+}
+
+void UsernameIndex::erase(size_t slot, const vector<User>& table) {
+    size_t b = findBucket(table[slot].getUsername(), table);
+    if (b == npos || buckets[b] != slot + 1) return;
+
+    // Backward-shift: pull later entries of the probe run into the hole
+    size_t mask = buckets.size() - 1;
+    buckets[b] = 0;
+    --count;
+    for (size_t next = (b + 1) & mask; buckets[next] != 0; next = (next + 1) & mask) {
+        size_t home = hash<string_view>{}(table[buckets[next] - 1].getUsername()) & mask;
+        bool between = (b <= next) ? (b < home && home <= next) : (b < home || home <= next);
+        if (!between) {
+            buckets[b] = buckets[next];
+            buckets[next] = 0;
+            b = next;
+        }
+    }
+}
+
+void UsernameIndex::relocate(size_t from, size_t to, const vector<User>& table) {
+    size_t b = findBucket(table[from].getUsername(), table);
+    if (b != npos && buckets[b] == from + 1) buckets[b] = static_cast<uint32_t>(to + 1);
+}
+
+// ==== USER SEARCH INDEX IMPLEMENTATION ====
+
+static const char GRAM_MARKER = '\x01';  // word-start padding; never part of typed text
+
+static uint32_t packGram(char a, char b, char c) {
+    return (uint32_t(uint8_t(a)) << 16) | (uint32_t(uint8_t(b)) << 8) | uint8_t(c);
+}
+
+static bool isWordStart(string_view text, size_t i) {
+    return isalnum(static_cast<unsigned char>(text[i])) &&
+           (i == 0 || !isalnum(static_cast<unsigned char>(text[i - 1])));
+}
+
+string UserSearchIndex::fold(string_view text) {
+    string folded(text);
+    for (char& c : folded) c = static_cast<char>(tolower(static_cast<unsigned char>(c)));
+    return folded;
+}
+
+bool UserSearchIndex::matches(string_view foldedQuery, string_view text) {
+    if (foldedQuery.empty() || foldedQuery.size() > text.size()) return false;
+    bool prefixOnly = foldedQuery.size() < 3;
+    for (size_t i = 0; i + foldedQuery.size() <= text.size(); ++i) {
+        if (prefixOnly && !isWordStart(text, i)) continue;
+        size_t k = 0;
+        while (k < foldedQuery.size() &&
+               tolower(static_cast<unsigned char>(text[i + k])) == static_cast<unsigned char>(foldedQuery[k])) {
+            ++k;
+        }
+        if (k == foldedQuery.size()) return true;
+    }
+    return false;
+}
+
+// text must already be folded
+void UserSearchIndex::collectGrams(string_view text, vector<uint32_t>& grams) {
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (isWordStart(text, i)) {
+            grams.push_back(packGram(GRAM_MARKER, GRAM_MARKER, text[i]));
+            if (i + 1 < text.size()) grams.push_back(packGram(GRAM_MARKER, text[i], text[i + 1]));
+        }
+        if (i + 2 < text.size()) grams.push_back(packGram(text[i], text[i + 1], text[i + 2]));
+    }
+}
+
+vector<uint32_t> UserSearchIndex::userGrams(string_view name, string_view username) {
+    vector<uint32_t> grams;
+    collectGrams(fold(name), grams);
+    collectGrams(fold(username), grams);
+    sort(grams.begin(), grams.end());
+    grams.erase(unique(grams.begin(), grams.end()), grams.end());
+    return grams;
+}
+
+vector<uint32_t> UserSearchIndex::queryGrams(string_view foldedQuery) {
+    vector<uint32_t> grams;
+    if (foldedQuery.size() == 1) {
+        grams.push_back(packGram(GRAM_MARKER, GRAM_MARKER, foldedQuery[0]));
+    } else if (foldedQuery.size() == 2) {
+        grams.push_back(packGram(GRAM_MARKER, foldedQuery[0], foldedQuery[1]));
+    } else {
+        for (size_t i = 0; i + 2 < foldedQuery.size(); ++i) {
+            grams.push_back(packGram(foldedQuery[i], foldedQuery[i + 1], foldedQuery[i + 2]));
+        }
+        sort(grams.begin(), grams.end());
+        grams.erase(unique(grams.begin(), grams.end()), grams.end());
+    }
+    return grams;
+}
+
+void UserSearchIndex::add(int id, string_view name, string_view username) {
+    for (uint32_t gram : userGrams(name, username)) {
+        vector<int>& list = postings[gram];
+        if (list.empty() || list.back() < id) {
+            list.push_back(id);  // the usual case: ids are handed out in increasing order
+        } else {
+            auto pos = lower_bound(list.begin(), list.end(), id);
+            if (pos == list.end() || *pos != id) list.insert(pos, id);
+        }
+    }
+}
+
+void UserSearchIndex::remove(int id, string_view name, string_view username) {
+    for (uint32_t gram : userGrams(name, username)) {
+        auto it = postings.find(gram);
+        if (it == postings.end()) continue;
+        vector<int>& list = it->second;
+        auto pos = lower_bound(list.begin(), list.end(), id);
+        if (pos != list.end() && *pos == id) list.erase(pos);
+        if (list.empty()) postings.erase(it);
+    }
+}
+
+// ==== USER SNAPSHOT (users.bin) IMPLEMENTATION ====
+
+// FNV-1a: stable across platforms and runs, unlike std::hash
+uint64_t UserSnapshot::hashUsername(string_view username) {
+    uint64_t h = 1469598103934665603ULL;
+    for (unsigned char c : username) {
+        h ^= c;
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+string UserSnapshot::build(const vector<User>& users, int nextID) {
+    // Records sorted by id so the file is deterministic for the same table
+    vector<const User*> sorted;
+    sorted.reserve(users.size());
+    size_t stringsSize = 0;
+    for (const auto& user : users) {
+        sorted.push_back(&user);
+        stringsSize += user.name.size() + user.username.size() + user.password.size();
+    }
+    sort(sorted.begin(), sorted.end(), [](const User* a, const User* b) { return a->userID < b->userID; });
+
+    uint32_t hashSlots = 16;
+    while (hashSlots < sorted.size() * 2) hashSlots <<= 1;
+
+    Header header{};
+    header.magic = MAGIC;
+    header.version = VERSION;
+    header.count = static_cast<uint32_t>(sorted.size());
+    header.nextID = nextID;
+    header.hashSlots = hashSlots;
+    header.stringsSize = stringsSize;
+
+    size_t recordsBytes = sorted.size() * sizeof(Record);
+    size_t slotsBytes = size_t(hashSlots) * sizeof(uint32_t);
+    string image(sizeof(Header) + recordsBytes + slotsBytes + stringsSize, '\0');
+    char* out = &image[0];
+    memcpy(out, &header, sizeof(Header));
+    Record* records = reinterpret_cast<Record*>(out + sizeof(Header));
+    uint32_t* slots = reinterpret_cast<uint32_t*>(out + sizeof(Header) + recordsBytes);
+    char* strings = out + sizeof(Header) + recordsBytes + slotsBytes;
+
+    uint32_t offset = 0;
+    auto appendString = [&](const string& s, uint32_t& off, uint32_t& len) {
+        off = offset;
+        len = static_cast<uint32_t>(s.size());
+        memcpy(strings + offset, s.data(), s.size());
+        offset += len;
+    };
+    for (size_t i = 0; i < sorted.size(); ++i) {
+        const User& user = *sorted[i];
+        Record& record = records[i];
+        record.id = user.userID;
+        record.role = static_cast<uint8_t>(user.role);
+        appendString(user.name, record.nameOffset, record.nameLength);
+        appendString(user.username, record.usernameOffset, record.usernameLength);
+        appendString(user.password, record.passwordOffset, record.passwordLength);
+
+        // Linear probing; the table is at most half full
+        size_t slot = hashUsername(user.username) & (hashSlots - 1);
+        while (slots[slot] != 0) slot = (slot + 1) & (hashSlots - 1);
+        slots[slot] = static_cast<uint32_t>(i + 1);
+    }
+    return image;
+}
+
+bool UserSnapshot::open(const filesystem::path& path) {
+    close();
+#ifdef _WIN32
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart < (LONGLONG)sizeof(Header)) {
+        CloseHandle(file);
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) {
+        CloseHandle(file);
+        return false;
+    }
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    fileHandle = file;
+    mappingHandle = mapping;
+    data = static_cast<const char*>(view);
+    length = static_cast<size_t>(fileSize.QuadPart);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(Header)) {
+        ::close(fd);
+        return false;
+    }
+    void* view = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);  // the mapping keeps the file alive
+    if (view == MAP_FAILED) return false;
+    data = static_cast<const char*>(view);
+    length = static_cast<size_t>(st.st_size);
+#endif
+
+    // Validate before trusting any offset in the file
+    header = reinterpret_cast<const Header*>(data);
+    size_t recordsBytes = size_t(header->count) * sizeof(Record);
+    size_t slotsBytes = size_t(header->hashSlots) * sizeof(uint32_t);
+    // The fixed part must fit before the pool size is compared; a sum with a
+    // corrupt stringsSize could wrap around and match length
+    size_t fixedBytes = sizeof(Header) + recordsBytes + slotsBytes;
+    bool valid = header->magic == MAGIC && header->version == VERSION &&
+                 header->hashSlots != 0 && (header->hashSlots & (header->hashSlots - 1)) == 0 &&
+                 fixedBytes <= length && header->stringsSize == length - fixedBytes;
+    if (!valid) {
+        close();
+        return false;
+    }
+    records = reinterpret_cast<const Record*>(data + sizeof(Header));
+    slots = reinterpret_cast<const uint32_t*>(data + sizeof(Header) + recordsBytes);
+    strings = data + sizeof(Header) + recordsBytes + slotsBytes;
+
+    // Then every record, string and slot, so at() never reads past the pool,
+    // findByUsername() always reaches an empty slot and nextID is above every id
+    auto inPool = [this](uint32_t offset, uint32_t length) {
+        return uint64_t(offset) + length <= header->stringsSize;
+    };
+    for (size_t i = 0; i < header->count && valid; ++i) {
+        const Record& r = records[i];
+        valid = inPool(r.nameOffset, r.nameLength) && inPool(r.usernameOffset, r.usernameLength) &&
+                inPool(r.passwordOffset, r.passwordLength) && r.id < header->nextID;
+    }
+    bool emptySlot = false;
+    for (size_t i = 0; i < header->hashSlots && valid; ++i) {
+        valid = slots[i] <= header->count;
+        emptySlot |= slots[i] == 0;
+    }
+    if (!valid || !emptySlot) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void UserSnapshot::close() {
+    if (data) {
+#ifdef _WIN32
+        UnmapViewOfFile(data);
+        CloseHandle(mappingHandle);
+        CloseHandle(fileHandle);
+        mappingHandle = fileHandle = nullptr;
+#else
+        munmap(const_cast<char*>(data), length);
+#endif
     }
+    data = nullptr;
+    length = 0;
+    header = nullptr;
+    records = nullptr;
+    slots = nullptr;
+    strings = nullptr;
+}
+
+UserSnapshot::UserView UserSnapshot::at(size_t index) const {
+    const Record& record = records[index];
+    Role role = record.role < ROLE_COUNT ? static_cast<Role>(record.role) : Role::Student;
+    return {record.id, role,
+            string_view(strings + record.nameOffset, record.nameLength),
+            string_view(strings + record.usernameOffset, record.usernameLength),
+            string_view(strings + record.passwordOffset, record.passwordLength)};
 }
 
-// Accessor for aggregated items
-vector<shared_ptr<User>>& ListManager::getAllItems() {
-    return items;
+// In-place lookup through the hash slots stored in the file
+bool UserSnapshot::findByUsername(string_view username, UserView& out) const {
+    if (!header) return false;
+    uint32_t mask = header->hashSlots - 1;
+    for (size_t slot = hashUsername(username) & mask; slots[slot] != 0; slot = (slot + 1) & mask) {
+        const Record& record = records[slots[slot] - 1];
+        if (string_view(strings + record.usernameOffset, record.usernameLength) == username) {
+            out = at(slots[slot] - 1);
+            return true;
+        }
+    }
+    return false;
 }
 
 // ==== USER MANAGER SINGLETON IMPLEMENTATION ====
 // Singleton Pattern: ensures only one instance
 UserManager* UserManager::getInstance() {
-    if (!instance) instance = new UserManager();  // Lazy initialization
+    static once_flag created;
+    call_once(created, [] { instance = new UserManager(); });  // Lazy, thread-safe initialization
     return instance;
 }
 
+// Index maintenance: every mutation of the table goes through these helpers
+void UserManager::indexUser(size_t slot) {
+    const User& user = users[slot];
+    usernameIndex.insert(slot, users);
+    idIndex[user.userID] = slot;
+    if (searchIndexBuilt) searchIndex.add(user.userID, user.name, user.username);
+
+    vector<uint32_t>& members = roleSlots[static_cast<size_t>(user.role)];
+    if (rolePosition.size() <= slot) rolePosition.resize(slot + 1);
+    rolePosition[slot] = static_cast<uint32_t>(members.size());
+    members.push_back(static_cast<uint32_t>(slot));
+}
+
+void UserManager::unindexUser(size_t slot) {
+    const User& user = users[slot];
+    usernameIndex.erase(slot, users);
+    auto byID = idIndex.find(user.userID);
+    if (byID != idIndex.end() && byID->second == slot) {
+        idIndex.erase(byID);
+    }
+    if (searchIndexBuilt) searchIndex.remove(user.userID, user.name, user.username);
+
+    vector<uint32_t>& members = roleSlots[static_cast<size_t>(user.role)];
+    uint32_t position = rolePosition[slot];
+    uint32_t lastMember = members.back();
+    members[position] = lastMember;
+    rolePosition[lastMember] = position;
+    members.pop_back();
+}
+
+User* UserManager::addUser(User user) {
+    users.push_back(move(user));
+    indexUser(users.size() - 1);
+    return &users.back();
+}
+
+// O(1) removal: move the last user into the freed slot and repoint its indexes
+void UserManager::removeSlot(size_t slot) {
+    unindexUser(slot);
+    size_t last = users.size() - 1;
+    if (slot != last) {
+        const User& moved = users[last];
+        usernameIndex.relocate(last, slot, users);
+        auto byID = idIndex.find(moved.userID);
+        if (byID != idIndex.end() && byID->second == last) byID->second = slot;
+        uint32_t position = rolePosition[last];
+        roleSlots[static_cast<size_t>(moved.role)][position] = static_cast<uint32_t>(slot);
+        rolePosition[slot] = position;
+        users[slot] = move(users[last]);
+    }
+    users.pop_back();
+    rolePosition.pop_back();
+}
+
+// Deferred table (see mappedUsers): built once, from the records in id order
+void UserManager::ensureTable() const {
+    if (!tableDeferred.load(memory_order_acquire)) return;
+    lock_guard<mutex> guard(tableMutex);
+    if (!tableDeferred.load(memory_order_relaxed)) return;
+    // Only fills in what the mapping already answers, so callers holding the shared lock may do it
+    const_cast<UserManager*>(this)->buildTableFromMapping();
+    tableDeferred.store(false, memory_order_release);
+}
+
+void UserManager::buildTableFromMapping() {
+    size_t count = mappedUsers.size();
+    users.reserve(count);
+    usernameIndex.reserve(count, users);
+    idIndex.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        UserSnapshot::UserView view = mappedUsers.at(i);
+        addUser(User::restore(view.id, view.role, string(view.name), string(view.username), string(view.password)));
+    }
+}
+
+// Caller holds the unique lock, so no reader can still be inside the mapping
+void UserManager::releaseMapping() {
+    ensureTable();
+    mappedUsers.close();
+}
+
+static User userFromView(const UserSnapshot::UserView& view) {
+    return User::restore(view.id, view.role, string(view.name), string(view.username), string(view.password));
+}
+
+const User* UserManager::findUserByUsername(const string& username) const {
+    ensureTable();  // hands out a pointer into the table
+    size_t slot = usernameIndex.find(username, users);
+    return slot != UsernameIndex::npos ? &users[slot] : nullptr;
+}
+
+const User* UserManager::findUserByID(int userID) const {
+    ensureTable();
+    auto it = idIndex.find(userID);
+    return it != idIndex.end() ? &users[it->second] : nullptr;
+}
+
+optional<User> UserManager::getUserByUsername(const string& username) const {
+    shared_lock<shared_mutex> lock(usersMutex);
+    if (tableDeferred.load(memory_order_acquire)) {
+        UserSnapshot::UserView view;
+        if (!mappedUsers.findByUsername(username, view)) return nullopt;
+        return userFromView(view);
+    }
+    size_t slot = usernameIndex.find(username, users);
+    if (slot == UsernameIndex::npos) return nullopt;
+    return users[slot];
+}
+
+optional<User> UserManager::getUserByID(int userID) const {
+    shared_lock<shared_mutex> lock(usersMutex);
+    ensureTable();
+    auto it = idIndex.find(userID);
+    if (it == idIndex.end()) return nullopt;
+    return users[it->second];
+}
+
+// Login check for concurrent front ends: no copies, no output
+bool UserManager::authenticate(const string& username, const string& password, int& userID, Role& role) const {
+    shared_lock<shared_mutex> lock(usersMutex);
+    if (tableDeferred.load(memory_order_acquire)) {
+        UserSnapshot::UserView view;
+        if (!mappedUsers.findByUsername(username, view) || view.password != password) return false;
+        userID = view.id;
+        role = view.role;
+        return true;
+    }
+    size_t slot = usernameIndex.find(username, users);
+    if (slot == UsernameIndex::npos || !users[slot].verifyPassword(password)) return false;
+    userID = users[slot].userID;
+    role = users[slot].role;
+    return true;
+}
+
+// Caller holds the unique lock
+void UserManager::buildSearchIndex() const {
+    if (searchIndexBuilt) return;
+    ensureTable();
+    // Deletes swap slots around, so add in id order to keep every append at a list's end
+    vector<pair<int, size_t>> byID;
+    byID.reserve(users.size());
+    for (size_t slot = 0; slot < users.size(); ++slot) byID.emplace_back(users[slot].userID, slot);
+    sort(byID.begin(), byID.end());
+    for (const auto& [id, slot] : byID) searchIndex.add(id, users[slot].name, users[slot].username);
+    searchIndexBuilt = true;
+}
+
+UserSearchPage UserManager::searchUsers(const string& query, size_t offset, size_t limit) const {
+    UserSearchPage page;
+    page.offset = offset;
+    size_t first = query.find_first_not_of(" \t");
+    if (first == string::npos || limit == 0) return page;
+    string folded = UserSearchIndex::fold(string_view(query).substr(first, query.find_last_not_of(" \t") - first + 1));
+
+    shared_lock<shared_mutex> lock(usersMutex);
+    if (!searchIndexBuilt) {
+        lock.unlock();
+        {
+            unique_lock<shared_mutex> writeLock(usersMutex);
+            buildSearchIndex();
+        }
+        lock.lock();  // once built the index is never dropped, so it is still there
+    }
+    size_t skipped = 0;
+    searchIndex.forEachCandidate(folded, [&](int id) {
+        auto it = idIndex.find(id);
+        if (it == idIndex.end()) return true;
+        const User& user = users[it->second];
+        if (!UserSearchIndex::matches(folded, user.name) && !UserSearchIndex::matches(folded, user.username)) {
+            return true;  // grams present but not contiguous
+        }
+        if (skipped < offset) {
+            ++skipped;
+            return true;
+        }
+        if (page.users.size() == limit) {
+            page.hasMore = true;
+            return false;
+        }
+        page.users.push_back(user);
+        return true;
+    });
+    return page;
+}
+
+size_t UserManager::getUserCount() const {
+    shared_lock<shared_mutex> lock(usersMutex);
+    if (tableDeferred.load(memory_order_acquire)) return mappedUsers.size();
+    return users.size();
+}
+
+User* UserManager::findMutableUser(int userID) {
+    auto it = idIndex.find(userID);
+    return it != idIndex.end() ? &users[it->second] : nullptr;
+}
+
 // Role-Based Object Creation + Aggregation
-void UserManager::registerUser(string name, string role, string username, string password) {
-    shared_ptr<User> newUser;
-    if (role == "Admin") newUser = make_shared<Admin>(name, username, password);
-    else if (role == "Teacher") newUser = make_shared<Teacher>(name, username, password);
-    else newUser = make_shared<Student>(name, username, password);
-
-    userList.addItem(newUser);  // Composition
-    users.push_back(newUser);   // Add to users vector as well
+bool UserManager::registerUser(string name, string role, string username, string password) {
+    unique_lock<shared_mutex> lock(usersMutex);
+    releaseMapping();
+    // Same rule as importUsers: a second user with this name would take over its login
+    if (usernameIndex.find(username, users) != UsernameIndex::npos) {
+        cout << "Username '" << username << "' already exists.\n";
+        return false;
+    }
+    User* added = addUser(User(move(name), roleOrStudent(role), move(username), move(password)));
+    if (journalAttached) appendToJournal({{"op", "put"}, {"user", added->toJSON()}});
     cout << "User registered successfully.\n";
+    return true;
 }
 
-// Simple Authentication + Polymorphic behavior
+// Simple Authentication (hash lookup instead of a scan)
 bool UserManager::loginUser(string username, string password) {
-    for (auto& user : userList.getAllItems()) {
-        if (user->getUsername() == username && user->verifyPassword(password)) {
+    shared_lock<shared_mutex> lock(usersMutex);
+    if (tableDeferred.load(memory_order_acquire)) {
+        UserSnapshot::UserView view;
+        if (mappedUsers.findByUsername(username, view) && view.password == password) {
             cout << "Login successful.\n";
-            user->displayDetails();
+            userFromView(view).displayDetails();
             return true;
         }
+        cout << "Invalid username or password.\n";
+        return false;
+    }
+    size_t slot = usernameIndex.find(username, users);
+    if (slot != UsernameIndex::npos && users[slot].verifyPassword(password)) {
+        cout << "Login successful.\n";
+        users[slot].displayDetails();
+        return true;
     }
     cout << "Invalid username or password.\n";
     return false;
@@ -157,73 +743,453 @@ void UserManager::logoutUser() {
 
 // Admin functionality (Controlled Deletion)
 void UserManager::deleteUser(int userID) {
-    userList.removeItem(userID);
-    
-    // Also remove from users vector
-    users.erase(remove_if(users.begin(), users.end(), [userID](shared_ptr<User> u) {
-        return u->getUserID() == userID;
-    }), users.end());
-    
+    unique_lock<shared_mutex> lock(usersMutex);
+    releaseMapping();
+    auto it = idIndex.find(userID);
+    if (it == idIndex.end()) {
+        cout << "User not found.\n";
+        return;
+    }
+    removeSlot(it->second);
+    if (journalAttached) appendToJournal({{"op", "del"}, {"id", userID}});
     cout << "User deleted.\n";
 }
 
 // Modify existing user info (Encapsulation)
 void UserManager::updateUser(int userID, string newName) {
-    for (auto& user : userList.getAllItems()) {
-        if (user->getUserID() == userID) {
-            user->name = newName;  // Direct access allowed here for brevity
-            
-            // Update in users vector as well
-            for (auto& u : users) {
-                if (u->getUserID() == userID) {
-                    u->name = newName;
-                }
-            }
-            
-            cout << "User name updated.\n";
-            return;
-        }
+    unique_lock<shared_mutex> lock(usersMutex);
+    releaseMapping();
+    User* user = findMutableUser(userID);
+    if (!user) {
+        cout << "User not found.\n";
+        return;
     }
-    cout << "User not found.\n";
+    if (searchIndexBuilt) searchIndex.remove(userID, user->name, user->username);
+    user->name = newName;  // Direct access allowed here for brevity
+    if (searchIndexBuilt) searchIndex.add(userID, user->name, user->username);
+    if (journalAttached) appendToJournal({{"op", "put"}, {"user", user->toJSON()}});
+    cout << "User name updated.\n";
 }
 
 // Overloaded display: All or single user
 void UserManager::displayUserInfo(int userID) {
+    shared_lock<shared_mutex> lock(usersMutex);
+    ensureTable();
     if (userID == -1) {
-        userList.displayAll();  // Composition & Polymorphism
+        getUserList().displayAll();  // Composition
     } else {
-        for (auto& user : userList.getAllItems()) {
-            if (user->getUserID() == userID) {
-                user->displayDetails();  // Polymorphism
-                return;
-            }
+        auto it = idIndex.find(userID);
+        if (it != idIndex.end()) {
+            users[it->second].displayDetails();
+            return;
         }
         cout << "User not found.\n";
     }
 }
 
-// JSON persistence
+// Writes a snapshot atomically: temp file first, then rename over the old one
+static bool writeSnapshotFile(const filesystem::path& path, const string& contents) {
+    filesystem::path tmpPath = path;
+    tmpPath += ".tmp";
+    {
+        ofstream outFile(tmpPath, ios::binary | ios::trunc);
+        if (!outFile) return false;
+        outFile << contents;
+        if (!outFile) return false;
+    }
+    error_code ec;
+    filesystem::rename(tmpPath, path, ec);
+    return !ec;
+}
+
+// Full snapshot, after which the journal holds nothing new. users.json is
+// written first so users.bin ends up the newer file and is preferred on load.
 void UserManager::saveUsersToFile() {
-    ofstream outFile("users.json");
-    json j;
-    for (const auto& user : userList.getAllItems()) {
-        j.push_back(user->toJSON());  // Serialization
+    unique_lock<shared_mutex> lock(usersMutex);
+    saveLocked();
+}
+
+void UserManager::saveLocked() {
+    finishCompaction(true);
+    releaseMapping();  // also lets users.bin be replaced on platforms that lock mapped files
+
+    json j = json::array();
+    for (const auto& user : users) {
+        j.push_back(user.toJSON());  // Serialization
+    }
+    if (!writeSnapshotFile(usersFilePath, j.dump(4))) return;
+    if (!writeSnapshotFile(usersBinPath, UserSnapshot::build(users, User::nextID))) return;
+
+    // Remember what we wrote so the next load does not read it back
+    statSnapshotFile(true, usersFileSignature);
+
+    if (journalAttached) {
+        journal.close();
+        ofstream(journalPath, ios::binary | ios::trunc);
+        error_code ec;
+        filesystem::remove(compactingJournalPath, ec);
+        journalBytes = 0;
+        journalRecords = 0;
     }
-    outFile << j.dump(4);
-    outFile.close();
 }
 
-// JSON loading + Polymorphic restoration
-void UserManager::loadUsersFromFile() {
-    ifstream inFile("users.json");
+// Cheap change check: a stat, no read and no allocation
+bool UserManager::statSnapshotFile(bool binary, FileSignature& sig) {
+    const filesystem::path& path = binary ? usersBinPath : usersFilePath;
+    error_code ec;
+    auto size = filesystem::file_size(path, ec);
+    if (ec) return false;
+    auto mtime = filesystem::last_write_time(path, ec);
+    if (ec) return false;
+    sig.binary = binary;
+    sig.size = static_cast<long long>(size);
+    sig.mtime = mtime;
+    sig.contentHash = 0;
+    return true;
+}
+
+// Upsert one record by id: existing users are updated in place, new ids appended.
+// A record whose username belongs to another user is reported and skipped;
+// indexing it would take the name over and lock the other user out
+void UserManager::mergeUser(int id, Role role, string name, string username, string password) {
+    size_t owner = usernameIndex.find(username, users);
+    if (owner != UsernameIndex::npos && users[owner].getUserID() != id) {
+        cout << "Skipping user " << id << ": username '" << username << "' already belongs to user "
+             << users[owner].getUserID() << ".\n";
+        return;
+    }
+
+    auto it = idIndex.find(id);
+    if (it == idIndex.end()) {
+        addUser(User::restore(id, role, move(name), move(username), move(password)));
+        if (id >= User::nextID) User::nextID = id + 1;  // callers hold the unique lock
+        return;
+    }
+
+    size_t slot = it->second;
+    User& existing = users[slot];
+    if (existing.username != username || existing.role != role || existing.name != name) {
+        unindexUser(slot);
+        existing.username = move(username);
+        existing.role = role;
+        existing.name = move(name);
+        indexUser(slot);
+    }
+    existing.password = move(password);
+}
+
+void UserManager::mergeUser(const json& item) {
+    mergeUser(item.at("id").get<int>(), roleOrStudent(item.at("role").get_ref<const string&>()),
+              item.at("name").get<string>(), item.at("username").get<string>(),
+              item.at("password").get<string>());
+}
+
+// Snapshot part of the load: picks the newer of users.bin/users.json and
+// skips it entirely when that file matches the last load/save
+void UserManager::loadSnapshot() {
+    FileSignature binSig, jsonSig;
+    bool haveBin = statSnapshotFile(true, binSig);
+    bool haveJSON = statSnapshotFile(false, jsonSig);
+    if (!haveBin && !haveJSON) return;
+
+    bool useBin = haveBin && (!haveJSON || binSig.mtime >= jsonSig.mtime);
+    FileSignature& current = useBin ? binSig : jsonSig;
+    if (current.binary == usersFileSignature.binary && current.size == usersFileSignature.size &&
+        current.mtime == usersFileSignature.mtime) {
+        return;
+    }
+
+    if (useBin && loadBinarySnapshot()) {
+        usersFileSignature = current;
+        return;
+    }
+    if (haveJSON) {
+        loadJSONSnapshot(jsonSig);  // also the fallback for an unreadable users.bin
+    }
+}
+
+// mmap users.bin. On a cold start the mapping is kept and the table is built
+// only when first needed (see mappedUsers); otherwise the records are merged
+// into the existing table by id, strings copied once from the mapping
+bool UserManager::loadBinarySnapshot() {
+    if (users.empty() && !tableDeferred) {
+        if (!mappedUsers.open(usersBinPath)) return false;
+        // Once, here under the unique lock: open() checked every id is below
+        // the header's nextID, so building the table later never has to
+        if (mappedUsers.getNextID() > User::nextID) User::nextID = mappedUsers.getNextID();
+        tableDeferred.store(mappedUsers.size() > 0, memory_order_release);
+        if (!tableDeferred) mappedUsers.close();
+        return true;
+    }
+
+    UserSnapshot snapshot;
+    if (!snapshot.open(usersBinPath)) return false;
+    releaseMapping();
+
+    size_t count = snapshot.size();
+    users.reserve(users.size() + count);
+    usernameIndex.reserve(users.size() + count, users);
+    idIndex.reserve(idIndex.size() + count);
+    for (size_t i = 0; i < count; ++i) {
+        UserSnapshot::UserView view = snapshot.at(i);
+        mergeUser(view.id, view.role, string(view.name), string(view.username), string(view.password));
+    }
+    if (snapshot.getNextID() > User::nextID) User::nextID = snapshot.getNextID();
+    return true;
+}
+
+// users.json import path (change-aware and merged by id)
+void UserManager::loadJSONSnapshot(FileSignature current) {
+    ifstream inFile(usersFilePath);
     if (!inFile.is_open()) return;
-    json j;
-    inFile >> j;
-    users.clear(); // Clear existing users
+    stringstream buffer;
+    buffer << inFile.rdbuf();
+    inFile.close();
+    string contents = buffer.str();
+
+    // Touched but identical (e.g. rewritten with the same data)
+    current.contentHash = hash<string>{}(contents);
+    if (!usersFileSignature.binary && current.contentHash == usersFileSignature.contentHash &&
+        usersFileSignature.size >= 0) {
+        usersFileSignature = current;
+        return;
+    }
+
+    json j = json::parse(contents);
+    releaseMapping();
+    users.reserve(users.size() + j.size());
     for (const auto& item : j) {
-        auto user = User::fromJSON(item);
-        userList.addItem(user);  // Polymorphic
-        users.push_back(user);   // Add to users vector as well
+        mergeUser(item);
     }
-    inFile.close();
+    usersFileSignature = current;
+}
+
+// Safe to call on every menu entry: an unchanged snapshot and journal cost a
+// few stats, and records are merged by id so repeated loads never duplicate users.
+void UserManager::loadUsersFromFile() {
+    unique_lock<shared_mutex> lock(usersMutex);
+    loadLocked();
+}
+
+void UserManager::loadLocked() {
+    finishCompaction(false);
+    if (!tableDeferred) mappedUsers.close();  // a reader already copied it into the table
+    if (!compaction.valid()) {
+        loadSnapshot();  // skipped while our own compaction is rewriting the snapshot
+    }
+
+    if (!journalAttached) {
+        // A journal left behind by an interrupted compaction predates users.journal
+        error_code ec;
+        if (filesystem::exists(compactingJournalPath, ec)) {
+            replayJournal(compactingJournalPath, 0);
+            journalAttached = true;
+            journalBytes = replayJournal(journalPath, 0);
+            saveLocked();
+            return;
+        }
+    }
+    journalAttached = true;
+
+    error_code ec;
+    auto size = filesystem::file_size(journalPath, ec);
+    if (!ec && size > journalBytes) {
+        journalBytes = replayJournal(journalPath, journalBytes);
+    }
+}
+
+// ==== USER JOURNAL ====
+// One JSON object per line: {"op":"put","user":{...}} or {"op":"del","id":N}
+
+void UserManager::appendToJournal(const json& record) {
+    if (!journalAttached) return;
+    if (!journal.is_open()) {
+        journal.open(journalPath, ios::binary | ios::app);
+        if (!journal) return;
+    }
+    string line = record.dump();
+    line += '\n';
+    journal << line;
+    journal.flush();
+    journalBytes += line.size();
+
+    if (++journalRecords >= JOURNAL_COMPACT_THRESHOLD) {
+        startCompaction();
+    }
+}
+
+void UserManager::applyJournalRecord(const json& record) {
+    releaseMapping();
+    const string& op = record.at("op").get_ref<const string&>();
+    if (op == "put") {
+        mergeUser(record.at("user"));
+    } else if (op == "del") {
+        auto it = idIndex.find(record.at("id").get<int>());
+        if (it != idIndex.end()) removeSlot(it->second);
+    }
+}
+
+// Applies complete lines from fromByte onward; returns the offset after the
+// last complete line so a torn trailing write is retried on the next load
+size_t UserManager::replayJournal(const filesystem::path& path, size_t fromByte) {
+    ifstream in(path, ios::binary);
+    if (!in.is_open()) return fromByte;
+    in.seekg(static_cast<streamoff>(fromByte));
+
+    size_t offset = fromByte;
+    string line;
+    while (getline(in, line)) {
+        if (in.eof()) break;  // no trailing newline: write still in progress
+        offset += line.size() + 1;
+        if (line.empty()) continue;
+        try {
+            applyJournalRecord(json::parse(line));
+        } catch (const json::exception&) {
+            // Skip a corrupt record rather than losing the rest of the journal
+        }
+    }
+    return offset;
+}
+
+// Rotates the journal and writes a new users.bin on a background thread.
+// The image is built here, so the worker never touches the live table.
+void UserManager::startCompaction() {
+    if (compaction.valid()) return;  // previous compaction still running
+    error_code ec;
+    if (filesystem::exists(compactingJournalPath, ec)) return;  // earlier one failed; keep its journal
+
+    journal.close();
+    filesystem::rename(journalPath, compactingJournalPath, ec);
+    if (ec) return;  // keep appending to the current journal
+    journalBytes = 0;
+    journalRecords = 0;
+
+    string image = UserSnapshot::build(users, User::nextID);
+    compaction = async(launch::async, [image = move(image)]() {
+        FileSignature sig;
+        if (!writeSnapshotFile(usersBinPath, image) || !statSnapshotFile(true, sig)) {
+            return FileSignature{};  // leave the rotated journal for the next load
+        }
+        error_code removeError;
+        filesystem::remove(compactingJournalPath, removeError);
+        return sig;
+    });
+}
+
+// Adopts the signature of a finished compaction so its snapshot is not re-read
+void UserManager::finishCompaction(bool wait) {
+    if (!compaction.valid()) return;
+    if (!wait && compaction.wait_for(chrono::seconds(0)) != future_status::ready) return;
+    FileSignature sig = compaction.get();
+    if (sig.size >= 0) usersFileSignature = sig;
+}
+
+// ==== BULK IMPORT ====
+
+UserImportReport UserManager::importUsers(istream& in, ImportFormat format) {
+    struct Row {
+        string name, roleText, username, password;
+        Role role = Role::Student;
+        size_t line = 0;
+    };
+    UserImportReport report;
+    vector<Row> rows;
+    unordered_map<string, size_t> batchUsernames;  // username -> line, for in-file duplicates
+
+    // Pass 1: parse and validate everything before touching the table; this
+    // runs without the lock so readers are not held up by a large file
+    string line;
+    vector<string> fields;
+    size_t lineNo = 0;
+    while (getline(in, line)) {
+        ++lineNo;
+        if (line.empty() || line == "\r") continue;
+
+        Row row;
+        if (format == ImportFormat::CSV) {
+            if (!parseCSVLine(line, fields)) {
+                report.errors.push_back({lineNo, "unterminated quoted field"});
+                continue;
+            }
+            if (lineNo == 1 && fields.size() == 4 && fields[0] == "name" && fields[2] == "username") {
+                continue;  // header
+            }
+            if (fields.size() != 4) {
+                report.errors.push_back({lineNo, "expected 4 fields (name,role,username,password), got " + to_string(fields.size())});
+                continue;
+            }
+            row = {move(fields[0]), move(fields[1]), move(fields[2]), move(fields[3])};
+        } else {
+            try {
+                json j = json::parse(line);
+                row = {j.at("name").get<string>(), j.at("role").get<string>(),
+                       j.at("username").get<string>(), j.at("password").get<string>()};
+            } catch (const json::exception& e) {
+                report.errors.push_back({lineNo, string("invalid JSON record: ") + e.what()});
+                continue;
+            }
+        }
+
+        if (row.name.empty() || row.username.empty() || row.password.empty()) {
+            report.errors.push_back({lineNo, "name, username and password are required"});
+        } else if (!parseRole(row.roleText, row.role)) {
+            report.errors.push_back({lineNo, "unknown role '" + row.roleText + "'"});
+        } else if (!batchUsernames.emplace(row.username, lineNo).second) {
+            report.errors.push_back({lineNo, "username '" + row.username + "' repeats line " +
+                                             to_string(batchUsernames[row.username])});
+        } else {
+            row.line = lineNo;
+            rows.push_back(move(row));
+        }
+    }
+    if (rows.empty()) return report;
+
+    // Pass 2, under the writer lock: drop rows that clash with existing users,
+    // then one reservation and construct; the User constructor hands out
+    // consecutive ids, so the batch occupies one contiguous block of nextID
+    unique_lock<shared_mutex> lock(usersMutex);
+    // An import can be the first thing a program does: load (and attach the
+    // journal) first, so clashes are checked against the stored users and the
+    // save below cannot drop them
+    if (!journalAttached) loadLocked();
+    releaseMapping();
+    size_t kept = 0;
+    for (auto& row : rows) {
+        if (usernameIndex.find(row.username, users) != UsernameIndex::npos) {
+            report.errors.push_back({row.line, "username '" + row.username + "' already exists"});
+        } else {
+            if (&rows[kept] != &row) rows[kept] = move(row);
+            ++kept;
+        }
+    }
+    rows.resize(kept);
+    sort(report.errors.begin(), report.errors.end(),
+         [](const UserImportReport::RowError& a, const UserImportReport::RowError& b) { return a.line < b.line; });
+    if (rows.empty()) return report;
+
+    users.reserve(users.size() + rows.size());
+    usernameIndex.reserve(users.size() + rows.size(), users);
+    idIndex.reserve(idIndex.size() + rows.size());
+    report.firstID = User::nextID;
+    for (auto& row : rows) {
+        addUser(User(move(row.name), row.role, move(row.username), move(row.password)));
+    }
+    report.lastID = User::nextID - 1;
+    report.imported = rows.size();
+
+    // Single write for the whole batch
+    saveLocked();
+    return report;
+}
+
+UserImportReport UserManager::importUsersFromFile(const string& path) {
+    ifstream in(path, ios::binary);
+    if (!in.is_open()) {
+        UserImportReport report;
+        report.errors.push_back({0, "cannot open " + path});
+        return report;
+    }
+    string ext = filesystem::path(path).extension().string();
+    ImportFormat format = (ext == ".jsonl" || ext == ".ndjson") ? ImportFormat::JSONLines : ImportFormat::CSV;
+    return importUsers(in, format);
 }
\ No newline at end of file
@@ -1,91 +1,397 @@
 #ifndef FUNCTIONS_H
 #define FUNCTIONS_H
 #include <iostream>
+#include <algorithm>
+#include <atomic>
 #include <string>
 #include <vector>
 #include <fstream>
+#include <memory>
+#include <cstdint>
+#include <string_view>
+#include <filesystem>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <unordered_map>
 #include"json.hpp"
+#include "bulk_import.h"
 
 using namespace std;
 using json = nlohmann::json;
 
+// One byte per user; values are also the role codes stored in users.bin
+enum class Role : uint8_t { Admin = 0, Teacher = 1, Student = 2 };
+const size_t ROLE_COUNT = 3;
+
+// Role sets for access checks: roleBit(Role::Admin) | roleBit(Role::Teacher) etc.
+inline constexpr uint8_t roleBit(Role role) { return uint8_t(1u << static_cast<uint8_t>(role)); }
+string_view roleName(Role role);
+bool parseRole(string_view name, Role& role);
+
+// Value-type user record: no vtable, stored contiguously in UserManager's table.
+// Admin/Teacher/Student below only fix the role; they add no data or behaviour.
 class User {
 protected:
     int userID;
+    Role role;
     string name;
-    string role;
     string username;
     string password;
     static int nextID;
 
+    // A stored user: keeps its id and leaves nextID alone
+    User(int id, Role role, string name, string username, string password);
+
 public:
-    User(string name, string role, string username, string password);
-    virtual void displayDetails() const;
+    User(string name, Role role, string username, string password);
+    void displayDetails() const;
     int getUserID() const;
-    string getUsername() const;
-    string getRole() const;
-    bool verifyPassword(string entered) const;
+    const string& getUsername() const;
+    const string& getName() const;
+    Role getRole() const;
+    string_view getRoleName() const;
+    bool verifyPassword(const string& entered) const;
 
-    virtual json toJSON() const;
-    static shared_ptr<User> fromJSON(const json& j);
+    json toJSON() const;
+    static User fromJSON(const json& j);
+    // Rebuilds a stored user with its original id. nextID is not touched, so
+    // readers may call it; whoever adds the user to a table keeps nextID ahead
+    static User restore(int id, Role role, string name, string username, string password);
 
     friend bool operator==(const User& u1, const User& u2);
     friend ostream& operator<<(ostream& out, const User& user);
     friend class UserManager;
+    friend class UserSnapshot;
 };
 
 class Admin : public User {
 public:
     Admin(string name, string username, string password);
-    void displayDetails() const override;
 };
 
 class Teacher : public User {
 public:
     Teacher(string name, string username, string password);
-    void displayDetails() const override;
 };
 
 class Student : public User {
 public:
     Student(string name, string username, string password);
-    void displayDetails() const override;
 };
 
+// Read-only view over the users owned by UserManager (no copies, no refcounts)
 class ListManager {
 private:
-    vector<shared_ptr<User>> items;
+    const vector<User>* items = nullptr;
 
 public:
-    void addItem(shared_ptr<User> item);
-    void removeItem(int id);
+    ListManager() = default;
+    explicit ListManager(const vector<User>& owner) : items(&owner) {}
     void displayAll() const;
-    vector<shared_ptr<User>>& getAllItems();
+    const vector<User>& getAllItems() const;
+    size_t size() const;
+};
+
+// Users of one role, iterated straight from UserManager's per-role slot list
+class RoleView {
+    const vector<User>* table;
+    const vector<uint32_t>* slots;
+
+public:
+    class iterator {
+        const vector<User>* table;
+        const uint32_t* pos;
+    public:
+        iterator(const vector<User>* t, const uint32_t* p) : table(t), pos(p) {}
+        const User& operator*() const { return (*table)[*pos]; }
+        const User* operator->() const { return &(*table)[*pos]; }
+        iterator& operator++() { ++pos; return *this; }
+        bool operator!=(const iterator& other) const { return pos != other.pos; }
+    };
+    RoleView(const vector<User>& t, const vector<uint32_t>& s) : table(&t), slots(&s) {}
+    iterator begin() const { return iterator(table, slots->data()); }
+    iterator end() const { return iterator(table, slots->data() + slots->size()); }
+    size_t size() const { return slots->size(); }
+};
+
+// Open-addressing username -> slot index. Buckets hold only table slots; the
+// key is read back from the table, so nothing is copied and the index stays
+// valid when the table reallocates.
+class UsernameIndex {
+    vector<uint32_t> buckets;   // slot + 1, 0 = empty
+    size_t count = 0;
+    size_t findBucket(string_view username, const vector<User>& table) const;
+    void grow(const vector<User>& table);
+
+public:
+    static const size_t npos = size_t(-1);
+    size_t find(string_view username, const vector<User>& table) const;
+    void insert(size_t slot, const vector<User>& table);       // replaces an equal username
+    void erase(size_t slot, const vector<User>& table);        // only if it maps to slot
+    void relocate(size_t from, size_t to, const vector<User>& table);  // table[to] holds the user now
+    void reserve(size_t users, const vector<User>& table);
+    void clear() { buckets.clear(); count = 0; }
+};
+
+// Trigram index over names and usernames for admin search, keyed by user id so
+// slot moves never touch it. Text is ASCII-lowercased; every word start also
+// gets marker grams ("^^a", "^ab") so one- and two-letter queries can match as
+// word prefixes. Posting lists are sorted ids, so candidates come out in id order.
+class UserSearchIndex {
+    unordered_map<uint32_t, vector<int>> postings;
+    static void collectGrams(string_view text, vector<uint32_t>& grams);
+    static vector<uint32_t> userGrams(string_view name, string_view username);
+
+public:
+    static string fold(string_view text);
+    // Queries of 3+ characters match anywhere, shorter ones at a word start
+    static bool matches(string_view foldedQuery, string_view text);
+    static vector<uint32_t> queryGrams(string_view foldedQuery);
+
+    void add(int id, string_view name, string_view username);
+    void remove(int id, string_view name, string_view username);
+    void clear() { postings.clear(); }
+
+    // Calls visit(id) for every id holding all of the query's grams, ascending,
+    // until visit returns false. Candidates still need matches() to confirm.
+    template <typename F>
+    void forEachCandidate(string_view foldedQuery, F&& visit) const {
+        vector<const vector<int>*> lists;
+        for (uint32_t gram : queryGrams(foldedQuery)) {
+            auto it = postings.find(gram);
+            if (it == postings.end()) return;
+            lists.push_back(&it->second);
+        }
+        if (lists.empty()) return;
+        sort(lists.begin(), lists.end(),
+             [](const vector<int>* a, const vector<int>* b) { return a->size() < b->size(); });
+        vector<size_t> cursor(lists.size(), 0);
+        for (int id : *lists[0]) {
+            bool inAll = true;
+            for (size_t i = 1; i < lists.size() && inAll; ++i) {
+                const vector<int>& list = *lists[i];
+                size_t& at = cursor[i];
+                at = lower_bound(list.begin() + at, list.end(), id) - list.begin();
+                inAll = at < list.size() && list[at] == id;
+            }
+            if (inAll && !visit(id)) return;
+        }
+    }
+};
+
+// Versioned binary image of the user table (users.bin), opened with mmap.
+// Layout: Header | Record[count] sorted by id | username hash slots | string pool.
+// Views returned by at()/findByUsername() point into the mapping and stay
+// valid until close(); reading them allocates nothing.
+class UserSnapshot {
+public:
+    static const uint32_t MAGIC = 0x31525355;  // "USR1" read as little-endian
+    static const uint32_t VERSION = 1;
+
+    struct Header {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t count;
+        int32_t nextID;
+        uint32_t hashSlots;      // power of two
+        uint32_t reserved;
+        uint64_t stringsSize;
+    };
+    struct Record {
+        int32_t id;
+        uint8_t role;            // Role value: 0 = Admin, 1 = Teacher, 2 = Student
+        uint8_t padding[3];
+        uint32_t nameOffset, nameLength;
+        uint32_t usernameOffset, usernameLength;
+        uint32_t passwordOffset, passwordLength;
+    };
+    struct UserView {
+        int id;
+        Role role;
+        string_view name;
+        string_view username;
+        string_view password;
+    };
+
+    UserSnapshot() = default;
+    UserSnapshot(const UserSnapshot&) = delete;
+    UserSnapshot& operator=(const UserSnapshot&) = delete;
+    ~UserSnapshot() { close(); }
+
+    // Serializes users into an in-memory image (written to disk by the caller)
+    static string build(const vector<User>& users, int nextID);
+
+    bool open(const filesystem::path& path);   // false if missing, truncated, corrupt or another version
+    void close();
+    bool isOpen() const { return data != nullptr; }
+
+    size_t size() const { return header ? header->count : 0; }
+    int getNextID() const { return header ? header->nextID : 1; }
+    UserView at(size_t index) const;
+    bool findByUsername(string_view username, UserView& out) const;
+
+private:
+    const char* data = nullptr;
+    size_t length = 0;
+    const Header* header = nullptr;
+    const Record* records = nullptr;
+    const uint32_t* slots = nullptr;      // record index + 1, 0 = empty
+    const char* strings = nullptr;
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#endif
+    static uint64_t hashUsername(string_view username);
+};
+
+// One page of search results, ordered by user id
+struct UserSearchPage {
+    vector<User> users;
+    size_t offset = 0;
+    bool hasMore = false;   // another page follows
 };
 
+// Bulk import outcome, shared with the question importer (bulk_import.h)
+using UserImportReport = ImportReport;
+
+// Thread safety: public members lock usersMutex themselves. Lookups, logins
+// and displays take it shared, so readers never block each other; mutations,
+// loads, saves and imports take it exclusively. The exceptions are the
+// accessors that hand out references or views (getAllUsers, getUsersByRole,
+// getUserList, find*): they do not lock, and what they return is only stable
+// while the caller holds lockForReading(). Threads that just need a record
+// should use getUserBy*() or authenticate(), which return copies.
 class UserManager {
 private:
     static UserManager* instance;
-    ListManager userList;
     UserManager() = default;
-    std::vector<std::shared_ptr<User>> users;
+    mutable shared_mutex usersMutex;
+
+    // Single owning user table of value records; deletes swap the last slot into the hole
+    vector<User> users;
+
+    // A cold start from users.bin only maps the file: login, authenticate,
+    // getUserByUsername and getUserCount answer from the mapping until a
+    // caller needs the table itself or writes. ensureTable() builds it under
+    // tableMutex (same contents, so readers may do it); the mapping is only
+    // closed under the writer lock, since other readers may still be in it.
+    UserSnapshot mappedUsers;
+    mutable atomic<bool> tableDeferred{false};
+    mutable mutex tableMutex;
+    void ensureTable() const;
+    void buildTableFromMapping();
+    void releaseMapping();
+
+    // Lookup indexes kept in sync with users (username/id -> slot in users)
+    UsernameIndex usernameIndex;
+    unordered_map<int, size_t> idIndex;
+
+    // Built on the first search (under the writer lock), then kept up to date
+    // by every mutation; registering and loading users never pay for it
+    mutable UserSearchIndex searchIndex;
+    mutable bool searchIndexBuilt = false;
+
+    // Per-role slot lists so "all students" needs no filtering; rolePosition[slot]
+    // is the slot's position in its role list, for O(1) removal
+    vector<uint32_t> roleSlots[ROLE_COUNT];
+    vector<uint32_t> rolePosition;
+
+    void indexUser(size_t slot);
+    void unindexUser(size_t slot);
+    User* addUser(User user);
+    void removeSlot(size_t slot);
+    User* findMutableUser(int userID);
+    void buildSearchIndex() const;
+
+    // Size/mtime/content hash of the snapshot (users.bin or users.json) as of
+    // the last load or save. loadUsersFromFile() skips reading when it matches.
+    struct FileSignature {
+        bool binary = false;
+        long long size = -1;
+        filesystem::file_time_type mtime{};
+        size_t contentHash = 0;
+    };
+    FileSignature usersFileSignature;
+    static bool statSnapshotFile(bool binary, FileSignature& sig);
+    void mergeUser(const json& item);
+    void mergeUser(int id, Role role, string name, string username, string password);
+    void saveLocked();
+    void loadLocked();
+    void loadSnapshot();
+    bool loadBinarySnapshot();
+    void loadJSONSnapshot(FileSignature current);
+
+    // Append-only change journal (users.journal), replayed on top of the snapshot.
+    // Mutations append one line each; a background compaction folds the journal
+    // into a fresh users.bin once it grows past JOURNAL_COMPACT_THRESHOLD records.
+    ofstream journal;
+    bool journalAttached = false;   // set by the first load; unattached managers keep no journal
+    size_t journalBytes = 0;        // bytes of users.journal already applied or written
+    size_t journalRecords = 0;      // records appended since the last compaction
+    future<FileSignature> compaction;
+    void appendToJournal(const json& record);
+    void applyJournalRecord(const json& record);
+    size_t replayJournal(const filesystem::path& path, size_t fromByte);
+    void startCompaction();
+    void finishCompaction(bool wait);
 
 public:
+    static const size_t JOURNAL_COMPACT_THRESHOLD = 1000;
+    enum class ImportFormat { CSV, JSONLines };
+
     static UserManager* getInstance();
-    const std::vector<std::shared_ptr<User>>& getAllUsers() const {
+
+    // Hold this while iterating views if other threads may be writing
+    shared_lock<shared_mutex> lockForReading() const {
+        return shared_lock<shared_mutex>(usersMutex);
+    }
+    const vector<User>& getAllUsers() const {
+        ensureTable();
         return users;
     }
-    void registerUser(string name, string role, string username, string password);
+    RoleView getUsersByRole(Role role) const {
+        ensureTable();
+        return RoleView(users, roleSlots[static_cast<size_t>(role)]);
+    }
+    bool registerUser(string name, string role, string username, string password);  // false if the username is taken
     bool loginUser(string username, string password);  // Changed return type to bool
     void logoutUser();
     void deleteUser(int userID);
     void updateUser(int userID, string newInfo);
     void displayUserInfo(int userID = -1);
-    void saveUsersToFile();
-    void loadUsersFromFile();
+    // users.bin is the primary snapshot; users.json is kept as an export and is
+    // loaded instead when it is newer (e.g. edited by hand or copied in)
+    void saveUsersToFile();     // full snapshot + JSON export; also empties the journal
+    void loadUsersFromFile();   // snapshot + journal, cheap when nothing changed
+
+    // Bulk onboarding: rows are name,role,username,password (CSV, optional header)
+    // or one {"name","role","username","password"} object per line (JSON Lines).
+    // Valid rows are added in one batch and persisted with a single write.
+    UserImportReport importUsers(istream& in, ImportFormat format);
+    UserImportReport importUsersFromFile(const string& path);  // format from .csv/.jsonl
+
+    // Indexed lookups: return nullptr when no such user exists.
+    // The pointer is only valid until the next write (see lockForReading()).
+    const User* findUserByUsername(const string& username) const;
+    const User* findUserByID(int userID) const;
+
+    // Thread-safe lookups: a shared lock for the lookup, the result copied out
+    optional<User> getUserByUsername(const string& username) const;
+    optional<User> getUserByID(int userID) const;
+    bool authenticate(const string& username, const string& password, int& userID, Role& role) const;
+    size_t getUserCount() const;
+
+    // Case-insensitive search over name and username (3+ characters: substring,
+    // fewer: word prefix). Results are copies ordered by id.
+    UserSearchPage searchUsers(const string& query, size_t offset = 0, size_t limit = 20) const;
     
-    // Add this to access userList if needed
-    ListManager& getUserList() { return userList; }
+    // View over the user table for display/iteration
+    ListManager getUserList() const {
+        ensureTable();
+        return ListManager(users);
+    }
 };
 
 #endif
\ No newline at end of file
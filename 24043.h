@@ -10,11 +10,58 @@
 #include <memory>
 #include <iomanip>
 #include <stdexcept>
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
+#include <list>
+#include <set>
+#include <filesystem>
+#include <string_view>
+#include <cstring>
+#include <random>
+#include <cmath>
+#include <charconv>
+#include <cstdio>
+#include <bitset>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 #include "json.hpp"
+#include "bulk_import.h"
 
 using namespace std;
 using json = nlohmann::json;
 
+// GCC/Clang builtin where available; MSVC has no __builtin_popcountll
+inline int popcount64(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(x);
+#else
+    return static_cast<int>(bitset<64>(x).count());
+#endif
+}
+
+// Index of the lowest set bit; x must be non-zero
+inline int countTrailingZeros64(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(x);
+#else
+    return popcount64((x & (0 - x)) - 1);
+#endif
+}
+
 class ExamException : public exception {
     string message;
 public:
@@ -34,22 +81,45 @@ public:
         : questionID(id), questionText(text), answer(ans) {}
 
     virtual void displayQuestion() const = 0;
-    virtual bool checkAnswer(string userAnswer) const = 0;
+    virtual bool checkAnswer(const string& userAnswer) const = 0;
     virtual json toJson() const = 0;
+    virtual unique_ptr<Question> clone() const = 0;
     
     virtual ~Question() {}
     int getQuestionID() const { return questionID; }
     string getQuestionText() const { return questionText; }
-    string getCorrectAnswer() const { return answer; }
+    virtual string getCorrectAnswer() const { return answer; }
     void setQuestionText(string newText) { questionText = newText; }
     void setAnswer(string newAnswer) { answer = newAnswer; }
 };
 
+// The correct answer and every submitted answer are option indices (one byte);
+// option text only appears when displaying. Options are named by the letters
+// A-Z, so there are at most 26.
 class MCQ : public Question {
     vector<string> options;
+    uint8_t correctOption;
 public:
-    MCQ(int id = 0, string text = "", string ans = "", vector<string> opts = {})
-        : Question(id, text, ans), options(opts) {}
+    static constexpr uint8_t NO_KEY = 0xFD;          // key could not be resolved; never matches
+    static constexpr uint8_t INVALID_CHOICE = 0xFE;  // answered with something that is not an option
+    static constexpr size_t MAX_OPTIONS = 26;        // one letter each; far below the sentinels
+
+    MCQ(int id = 0, string text = "", int correct = NO_KEY, vector<string> opts = {})
+        : Question(id, text, ""), options(opts),
+          correctOption(correct >= 0 && static_cast<size_t>(correct) < options.size() ? correct : NO_KEY) {}
+
+    // Option index for what someone typed: the exact option text, else a
+    // letter (A, b, ...). -1 when it names no option.
+    static int resolveChoice(const vector<string>& opts, const string& input) {
+        for (size_t i = 0; i < opts.size(); ++i)
+            if (opts[i] == input) return static_cast<int>(i);
+        if (input.size() == 1 && isalpha(static_cast<unsigned char>(input[0]))) {
+            size_t index = toupper(static_cast<unsigned char>(input[0])) - 'A';
+            if (index < opts.size()) return static_cast<int>(index);
+        }
+        return -1;
+    }
+    int resolveChoice(const string& input) const { return resolveChoice(options, input); }
 
     void displayQuestion() const override {
         cout << "Q" << questionID << ": " << questionText << endl;
@@ -57,26 +127,43 @@ public:
             cout << char('A' + i) << ") " << options[i] << endl;
     }
 
-    bool checkAnswer(string userAnswer) const override {
-        return userAnswer == answer;
+    bool checkAnswer(const string& userAnswer) const override {
+        int choice = resolveChoice(userAnswer);
+        return choice >= 0 && checkChoice(static_cast<uint8_t>(choice));
+    }
+
+    bool checkChoice(uint8_t choice) const { return choice == correctOption; }
+    uint8_t getCorrectOption() const { return correctOption; }
+
+    // "C) islamabad", or "-" for INVALID_CHOICE and other non-options
+    string describeChoice(uint8_t choice) const {
+        if (choice >= options.size()) return "-";
+        return string(1, char('A' + choice)) + ") " + options[choice];
     }
 
+    string getCorrectAnswer() const override { return describeChoice(correctOption); }
+
     json toJson() const override {
         return {
             {"type", "MCQ"},
             {"questionID", questionID},
             {"questionText", questionText},
-            {"answer", answer},
+            {"answer", correctOption == NO_KEY ? -1 : static_cast<int>(correctOption)},
             {"options", options}
         };
     }
 
+    unique_ptr<Question> clone() const override {
+        return make_unique<MCQ>(*this);
+    }
+
     explicit operator string() const {
         return "MCQ: " + questionText + " (" + to_string(options.size()) + " options)";
     }
 
     void setOptions(vector<string> opts) {
         options = opts;
+        if (correctOption >= options.size()) correctOption = NO_KEY;
     }
     
     vector<string> getOptions() const {
@@ -93,7 +180,7 @@ public:
         cout << "Q" << questionID << ": " << questionText << " [Descriptive]" << endl;
     }
 
-    bool checkAnswer(string userAnswer) const override {
+    bool checkAnswer(const string& userAnswer) const override {
         return userAnswer == answer;
     }
 
@@ -105,13 +192,447 @@ public:
             {"answer", answer}
         };
     }
+
+    unique_ptr<Question> clone() const override {
+        return make_unique<Descriptive>(*this);
+    }
+};
+
+// Stored as one bit and answered like a two-option MCQ: True is option 0,
+// False option 1, so it grades through the same one-byte choice path.
+class TrueFalse : public Question {
+    bool correct;
+public:
+    TrueFalse(int id = 0, string text = "", bool ans = true)
+        : Question(id, text, ""), correct(ans) {}
+
+    static const vector<string>& options() {
+        static const vector<string> labels = {"True", "False"};
+        return labels;
+    }
+
+    // 0 for True, 1 for False, -1 otherwise. Accepts true/false, t/f and the
+    // letters A/B, in any case
+    static int parseChoice(string_view input) {
+        auto is = [input](string_view word) {
+            if (input.size() != word.size()) return false;
+            for (size_t i = 0; i < word.size(); ++i)
+                if (tolower(static_cast<unsigned char>(input[i])) != word[i]) return false;
+            return true;
+        };
+        if (is("true") || is("t") || is("a")) return 0;
+        if (is("false") || is("f") || is("b")) return 1;
+        return -1;
+    }
+
+    void displayQuestion() const override {
+        cout << "Q" << questionID << ": " << questionText << " [True/False]" << endl;
+        cout << "A) True" << endl << "B) False" << endl;
+    }
+
+    bool checkAnswer(const string& userAnswer) const override {
+        return parseChoice(userAnswer) == getCorrectOption();
+    }
+
+    uint8_t getCorrectOption() const { return correct ? 0 : 1; }
+    bool getAnswerValue() const { return correct; }
+    string getCorrectAnswer() const override { return correct ? "True" : "False"; }
+
+    json toJson() const override {
+        return {
+            {"type", "TrueFalse"},
+            {"questionID", questionID},
+            {"questionText", questionText},
+            {"answer", correct}
+        };
+    }
+
+    unique_ptr<Question> clone() const override {
+        return make_unique<TrueFalse>(*this);
+    }
+};
+
+// Any number of correct options, kept as a bitmask. Options are named by
+// the letters A-Z, so there are at most 26. Answers are option letters ("A,C", "AC", "a c"); credit is
+// (right picks - wrong picks) / correct options, never below zero.
+class MultiSelect : public Question {
+    vector<string> options;
+    uint64_t correctMask;
+public:
+    static constexpr size_t MAX_OPTIONS = 26;   // one letter each
+
+    MultiSelect(int id = 0, string text = "", uint64_t mask = 0, vector<string> opts = {})
+        : Question(id, text, ""), options(opts), correctMask(mask & maskFor(options.size())) {}
+
+    static uint64_t maskFor(size_t optionCount) {
+        return optionCount >= 64 ? ~0ull : (1ull << optionCount) - 1;
+    }
+
+    // Letters separated by anything that is not a letter; false when empty or
+    // when a letter names no option
+    static bool parseSelection(string_view input, size_t optionCount, uint64_t& mask) {
+        mask = 0;
+        for (char c : input) {
+            if (!isalpha(static_cast<unsigned char>(c))) continue;
+            size_t index = toupper(static_cast<unsigned char>(c)) - 'A';
+            if (index >= optionCount) return false;
+            mask |= 1ull << index;
+        }
+        return mask != 0;
+    }
+
+    static double credit(uint64_t selected, uint64_t correct) {
+        if (!correct) return 0;
+        int right = popcount64(selected & correct);
+        int wrong = popcount64(selected & ~correct);
+        return right > wrong ? double(right - wrong) / popcount64(correct) : 0;
+    }
+
+    // "A, C"
+    static string describeMask(uint64_t mask) {
+        string out;
+        for (size_t i = 0; i < MAX_OPTIONS; ++i) {
+            if (!(mask >> i & 1)) continue;
+            if (!out.empty()) out += ", ";
+            out += char('A' + i);
+        }
+        return out.empty() ? "-" : out;
+    }
+
+    void displayQuestion() const override {
+        cout << "Q" << questionID << ": " << questionText << " [Select all that apply]" << endl;
+        for (size_t i = 0; i < options.size(); ++i)
+            cout << char('A' + i) << ") " << options[i] << endl;
+    }
+
+    bool checkAnswer(const string& userAnswer) const override {
+        uint64_t selected;
+        return parseSelection(userAnswer, options.size(), selected) && selected == correctMask && correctMask;
+    }
+
+    uint64_t getCorrectMask() const { return correctMask; }
+    string getCorrectAnswer() const override { return describeMask(correctMask); }
+    const vector<string>& getOptions() const { return options; }
+
+    json toJson() const override {
+        json correct = json::array();
+        for (size_t i = 0; i < options.size(); ++i)
+            if (correctMask >> i & 1) correct.push_back(i);
+        return {
+            {"type", "MultiSelect"},
+            {"questionID", questionID},
+            {"questionText", questionText},
+            {"answer", correct},
+            {"options", options}
+        };
+    }
+
+    unique_ptr<Question> clone() const override {
+        return make_unique<MultiSelect>(*this);
+    }
+};
+
+// A number, accepted within max(absolute, relative * |value|) of the key.
+// The tolerance is worked out once here, not on every check.
+class Numeric : public Question {
+    double value;
+    double absoluteTolerance;
+    double relativeTolerance;
+    double tolerance;
+public:
+    Numeric(int id = 0, string text = "", double val = 0, double absTol = 0, double relTol = 0)
+        : Question(id, text, ""), value(val), absoluteTolerance(fabs(absTol)), relativeTolerance(fabs(relTol)),
+          tolerance(max(absoluteTolerance, relativeTolerance * fabs(val))) {}
+
+    // The whole input (surrounding spaces and a leading '+' allowed) must be a number
+    static bool parse(string_view input, double& out) {
+        while (!input.empty() && isspace(static_cast<unsigned char>(input.front()))) input.remove_prefix(1);
+        while (!input.empty() && isspace(static_cast<unsigned char>(input.back()))) input.remove_suffix(1);
+        if (!input.empty() && input.front() == '+') input.remove_prefix(1);
+        if (input.empty()) return false;
+        auto [end, error] = from_chars(input.data(), input.data() + input.size(), out);
+        return error == errc() && end == input.data() + input.size() && isfinite(out);
+    }
+
+    static bool within(double answer, double expected, double tolerance) {
+        return fabs(answer - expected) <= tolerance;
+    }
+
+    void displayQuestion() const override {
+        cout << "Q" << questionID << ": " << questionText << " [Numeric]" << endl;
+    }
+
+    bool checkAnswer(const string& userAnswer) const override {
+        double answer;
+        return parse(userAnswer, answer) && within(answer, value, tolerance);
+    }
+
+    double getValue() const { return value; }
+    double getTolerance() const { return tolerance; }
+    double getAbsoluteTolerance() const { return absoluteTolerance; }
+    double getRelativeTolerance() const { return relativeTolerance; }
+
+    // "9.81 (+/- 0.05)"
+    string getCorrectAnswer() const override {
+        ostringstream out;
+        out << value;
+        if (tolerance > 0) out << " (+/- " << tolerance << ")";
+        return out.str();
+    }
+
+    json toJson() const override {
+        json j = {
+            {"type", "Numeric"},
+            {"questionID", questionID},
+            {"questionText", questionText},
+            {"answer", value}
+        };
+        if (absoluteTolerance > 0) j["absTolerance"] = absoluteTolerance;
+        if (relativeTolerance > 0) j["relTolerance"] = relativeTolerance;
+        return j;
+    }
+
+    unique_ptr<Question> clone() const override {
+        return make_unique<Numeric>(*this);
+    }
+};
+
+// Immutable, shared question set. An exam publishes one of these and every
+// session holds the same pointer; edits build a new set (copy-on-write) that
+// shares the untouched questions, so sessions keep the version they started on.
+// Iteration follows insertion order; a questionID -> slot index gives O(1) find().
+class QuestionSet {
+public:
+    using Items = vector<shared_ptr<const Question>>;
+    static const size_t npos = size_t(-1);
+
+    QuestionSet() = default;
+    explicit QuestionSet(Items list) : items(move(list)) {
+        slots.reserve(items.size());
+        for (size_t i = 0; i < items.size(); ++i)
+            slots.emplace(items[i]->getQuestionID(), static_cast<uint32_t>(i));  // first one wins
+    }
+
+    Items::const_iterator begin() const { return items.begin(); }
+    Items::const_iterator end() const { return items.end(); }
+    size_t size() const { return items.size(); }
+    bool empty() const { return items.empty(); }
+    const shared_ptr<const Question>& operator[](size_t slot) const { return items[slot]; }
+    const Items& getItems() const { return items; }
+
+    size_t slotOf(int questionID) const {
+        auto it = slots.find(questionID);
+        return it != slots.end() ? it->second : npos;
+    }
+    const Question* find(int questionID) const {
+        size_t slot = slotOf(questionID);
+        return slot != npos ? items[slot].get() : nullptr;
+    }
+
+private:
+    Items items;
+    unordered_map<int, uint32_t> slots;
+};
+using QuestionSetPtr = shared_ptr<const QuestionSet>;
+
+inline const QuestionSetPtr& emptyQuestionSet() {
+    static const QuestionSetPtr empty = make_shared<const QuestionSet>();
+    return empty;
+}
+
+class ExamImage;
+
+// Flat answer key compiled from a question set or an exam image. Every MCQ
+// and True/False question gets a dense slot [0, mcqCount()) holding its
+// correct option index as one byte; the rest are answered with text and get
+// text slots. A packed sheet is mcqCount() option bytes in the same slot
+// order, UNANSWERED where blank. MultiSelect and Numeric slots keep their
+// key as a mask or a number, so checking them parses the answer in place.
+class AnswerKey {
+    enum class SlotKind : uint8_t { Text, Selection, Number };
+
+    struct TextSlot {
+        int questionID;
+        SlotKind kind = SlotKind::Text;
+        const Question* question = nullptr;  // Text: checked through the question when set,
+        string_view expected;                // else compared to the expected text (images)
+        uint64_t mask = 0;                   // Selection: correct options
+        uint16_t optionCount = 0;
+        double value = 0, tolerance = 0;     // Number
+
+        // 0..1; only Selection gives partial credit
+        double credit(const string& answer) const {
+            switch (kind) {
+            case SlotKind::Selection: {
+                uint64_t selected;
+                return MultiSelect::parseSelection(answer, optionCount, selected) ? MultiSelect::credit(selected, mask) : 0;
+            }
+            case SlotKind::Number: {
+                double number;
+                return Numeric::parse(answer, number) && Numeric::within(number, value, tolerance) ? 1 : 0;
+            }
+            default:
+                return (question ? question->checkAnswer(answer) : answer == expected) ? 1 : 0;
+            }
+        }
+        bool check(const string& answer) const { return credit(answer) == 1; }
+    };
+
+    shared_ptr<const void> source;      // keeps the questions below alive
+    vector<uint8_t> mcqCodes;           // slot -> correct option index (MCQ::NO_KEY if unset)
+    vector<TextSlot> textSlots;
+    unordered_map<int, uint32_t> slotOf; // questionID -> MCQ slot, or mcqCount() + text slot
+    vector<int> slotQuestions;           // slot -> questionID
+
+    void indexTextSlots() {
+        for (size_t i = 0; i < textSlots.size(); ++i) {
+            slotOf[textSlots[i].questionID] = static_cast<uint32_t>(mcqCodes.size() + i);
+            slotQuestions.push_back(textSlots[i].questionID);
+        }
+    }
+
+public:
+    static constexpr uint8_t UNANSWERED = 0xFF;
+
+    explicit AnswerKey(QuestionSetPtr questions) {
+        auto addChoice = [this](int questionID, uint8_t correct) {
+            slotOf[questionID] = static_cast<uint32_t>(mcqCodes.size());
+            slotQuestions.push_back(questionID);
+            mcqCodes.push_back(correct);
+        };
+        for (const auto& q : *questions) {
+            TextSlot slot;
+            slot.questionID = q->getQuestionID();
+            if (const MCQ* mcq = dynamic_cast<const MCQ*>(q.get())) {
+                addChoice(slot.questionID, mcq->getCorrectOption());
+                continue;
+            } else if (const TrueFalse* trueFalse = dynamic_cast<const TrueFalse*>(q.get())) {
+                addChoice(slot.questionID, trueFalse->getCorrectOption());
+                continue;
+            } else if (const MultiSelect* multi = dynamic_cast<const MultiSelect*>(q.get())) {
+                slot.kind = SlotKind::Selection;
+                slot.mask = multi->getCorrectMask();
+                slot.optionCount = static_cast<uint16_t>(multi->getOptions().size());
+            } else if (const Numeric* numeric = dynamic_cast<const Numeric*>(q.get())) {
+                slot.kind = SlotKind::Number;
+                slot.value = numeric->getValue();
+                slot.tolerance = numeric->getTolerance();
+            } else {
+                slot.question = q.get();
+            }
+            textSlots.push_back(slot);
+        }
+        indexTextSlots();
+        source = move(questions);
+    }
+
+    // Expected answers are views into the image, which must outlive the key
+    explicit AnswerKey(const ExamImage& image);
+
+    size_t size() const { return mcqCodes.size() + textSlots.size(); }
+    size_t mcqCount() const { return mcqCodes.size(); }
+    // Slots graded without a person: choices, selections and numbers
+    size_t objectiveCount() const {
+        return mcqCodes.size() + count_if(textSlots.begin(), textSlots.end(),
+                                          [](const TextSlot& slot) { return slot.kind != SlotKind::Text; });
+    }
+    const uint8_t* codes() const { return mcqCodes.data(); }
+
+    static const size_t npos = size_t(-1);
+    size_t slotFor(int questionID) const {
+        auto it = slotOf.find(questionID);
+        return it != slotOf.end() ? it->second : npos;
+    }
+    int questionAt(size_t slot) const { return slotQuestions[slot]; }
+
+    // Text slot (mcqCount() + i): -1 when not answered, else whether it earns full credit
+    int checkText(size_t slot, const map<int, string>& texts) const {
+        const TextSlot& text = textSlots[slot - mcqCodes.size()];
+        auto it = texts.find(text.questionID);
+        return it == texts.end() ? -1 : text.check(it->second);
+    }
+
+    // Writes the mcqCount() option bytes of a sheet to out
+    void packMCQ(const map<int, uint8_t>& choices, uint8_t* out) const {
+        fill(out, out + mcqCodes.size(), UNANSWERED);
+        for (const auto& [questionID, choice] : choices) {
+            auto it = slotOf.find(questionID);
+            if (it != slotOf.end() && it->second < mcqCodes.size()) out[it->second] = choice;
+        }
+    }
+
+    // Number of positions where a and b hold the same byte
+    static size_t countEqual(const uint8_t* a, const uint8_t* b, size_t n) {
+        size_t matches = 0, i = 0;
+#ifdef __SSE2__
+        for (; i + 16 <= n; i += 16) {
+            __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+            __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+            matches += popcount64(static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(va, vb))));
+        }
+#endif
+        for (; i < n; ++i) matches += a[i] == b[i];
+        return matches;
+    }
+
+    // Grading kernel: correct MCQ answers in a packed sheet; no allocation
+    size_t scoreMCQ(const uint8_t* packed) const {
+        return countEqual(mcqCodes.data(), packed, mcqCodes.size());
+    }
+
+    // Sum of credits; a MultiSelect answer may earn part of its point
+    double scoreText(const map<int, string>& texts) const {
+        double credits = 0;
+        for (const TextSlot& slot : textSlots) {
+            auto it = texts.find(slot.questionID);
+            if (it != texts.end()) credits += slot.credit(it->second);
+        }
+        return credits;
+    }
+
+    // Whole-sheet score in points (one per question): MCQ choices plus text answers
+    double score(const map<int, uint8_t>& choices, const map<int, string>& texts) const {
+        uint8_t stackBuffer[256];
+        vector<uint8_t> heapBuffer;
+        uint8_t* packed = stackBuffer;
+        if (mcqCodes.size() > sizeof(stackBuffer)) {
+            heapBuffer.resize(mcqCodes.size());
+            packed = heapBuffer.data();
+        }
+        packMCQ(choices, packed);
+        return scoreMCQ(packed) + scoreText(texts);
+    }
+
+    bool isCorrect(int questionID, const map<int, uint8_t>& choices, const map<int, string>& texts) const {
+        auto slot = slotOf.find(questionID);
+        if (slot == slotOf.end()) return false;
+        if (slot->second < mcqCodes.size()) {
+            auto choice = choices.find(questionID);
+            return choice != choices.end() && choice->second == mcqCodes[slot->second];
+        }
+        auto text = texts.find(questionID);
+        return text != texts.end() && textSlots[slot->second - mcqCodes.size()].check(text->second);
+    }
 };
 
 class Exam {
     int examID;
     string subject;
     int duration;
-    vector<unique_ptr<Question>> questions;
+    QuestionSetPtr questions = emptyQuestionSet();
+    int version = 0;            // exam version id, bumped on every edit; persisted in the shard
+    mutable shared_ptr<const AnswerKey> answerKey;  // compiled lazily per published set
+    bool dirty = false;         // changed since it was last loaded or saved
+    bool randomized = false;    // per-student variants: shuffled questions and options
+    int drawCount = 0;          // questions each student draws from the pool; 0 = all
+    uint64_t variantSalt = 0;   // mixed into every variant seed of this exam
+
+    void publish(QuestionSet::Items next) {
+        questions = make_shared<const QuestionSet>(move(next));
+        ++version;
+        answerKey.reset();
+        dirty = true;
+    }
 public:
     Exam(int id = 0, string subj = "", int dur = 0) 
         : examID(id), subject(subj), duration(dur) {}
@@ -120,7 +641,13 @@ public:
         : examID(other.examID), 
           subject(move(other.subject)),
           duration(other.duration),
-          questions(move(other.questions)) {}
+          questions(move(other.questions)),
+          version(other.version),
+          answerKey(move(other.answerKey)),
+          dirty(other.dirty),
+          randomized(other.randomized),
+          drawCount(other.drawCount),
+          variantSalt(other.variantSalt) {}
 
     Exam& operator=(Exam&& other) noexcept {
         if (this != &other) {
@@ -128,38 +655,58 @@ public:
             subject = move(other.subject);
             duration = other.duration;
             questions = move(other.questions);
+            version = other.version;
+            answerKey = move(other.answerKey);
+            dirty = other.dirty;
+            randomized = other.randomized;
+            drawCount = other.drawCount;
+            variantSalt = other.variantSalt;
         }
         return *this;
     }
 
     void addQuestion(unique_ptr<Question> question) {
         if (!question) throw ExamException("Null pointer passed to addQuestion()");
-        questions.push_back(move(question));
+        QuestionSet::Items next = questions->getItems();
+        next.push_back(move(question));
+        publish(move(next));
+    }
+
+    // One published set for the whole batch, however many questions it holds
+    void addQuestions(vector<unique_ptr<Question>> batch) {
+        if (batch.empty()) return;
+        QuestionSet::Items next = questions->getItems();
+        next.reserve(next.size() + batch.size());
+        for (auto& question : batch) {
+            if (!question) throw ExamException("Null pointer passed to addQuestions()");
+            next.push_back(move(question));
+        }
+        publish(move(next));
     }
 
     void removeQuestion(int questionID) {
-        questions.erase(
-            remove_if(questions.begin(), questions.end(),
-                [questionID](const unique_ptr<Question>& q) {
-                    return q->getQuestionID() == questionID;
-                }),
-            questions.end());
+        size_t slot = questions->slotOf(questionID);
+        if (slot == QuestionSet::npos) return;
+        QuestionSet::Items next = questions->getItems();
+        next.erase(next.begin() + slot);  // keeps the order of the rest
+        publish(move(next));
     }
 
+    // Copy-on-write: only the edited question is cloned, the rest are shared
     void modifyQuestion(int questionID, string newText) {
-        for (auto& q : questions) {
-            if (q->getQuestionID() == questionID) {
-                q->setQuestionText(newText);
-                return;
-            }
-        }
-        throw ExamException("Question ID not found");
+        size_t slot = questions->slotOf(questionID);
+        if (slot == QuestionSet::npos) throw ExamException("Question ID not found");
+        unique_ptr<Question> edited = (*questions)[slot]->clone();
+        edited->setQuestionText(newText);
+        QuestionSet::Items next = questions->getItems();
+        next[slot] = move(edited);
+        publish(move(next));
     }
 
     void displayExam() const {
         cout << "Exam ID: " << examID << ", Subject: " << subject 
              << ", Duration: " << duration << " mins\n";
-        for (const auto& q : questions)
+        for (const auto& q : *questions)
             q->displayQuestion();
     }
 
@@ -167,267 +714,2521 @@ public:
     string getSubject() const { return subject; }
     int getDuration() const { return duration; }
 
-    vector<shared_ptr<Question>> getQuestionsCopy() const {
-        vector<shared_ptr<Question>> questionsCopy;
-        for (const auto& q : questions) {
-            if (dynamic_cast<MCQ*>(q.get())) {
-                auto mcq = dynamic_cast<MCQ*>(q.get());
-                questionsCopy.push_back(make_shared<MCQ>(
-                    mcq->getQuestionID(), 
-                    mcq->getQuestionText(), 
-                    mcq->getCorrectAnswer(), 
-                    mcq->getOptions()
-                ));
-            } else if (dynamic_cast<Descriptive*>(q.get())) {
-                auto desc = dynamic_cast<Descriptive*>(q.get());
-                questionsCopy.push_back(make_shared<Descriptive>(
-                    desc->getQuestionID(), 
-                    desc->getQuestionText(), 
-                    desc->getCorrectAnswer()
-                ));
-            }
-        }
-        return questionsCopy;
-    }
-
-    map<int, bool> checkAnswers(const map<int, string>& userAnswers) const {
+    // The current published set; holders keep it alive across later edits
+    QuestionSetPtr getQuestions() const { return questions; }
+    // Identifies what students see; an image built from this exam carries it
+    int getVersion() const { return version; }
+
+    bool isRandomized() const { return randomized; }
+    int getDrawCount() const { return drawCount; }
+    uint64_t getVariantSalt() const { return variantSalt; }
+    void setRandomization(bool enabled, int draw, uint64_t salt) {
+        randomized = enabled;
+        drawCount = enabled ? draw : 0;
+        variantSalt = enabled ? salt : 0;
+        ++version;  // the variants students draw change too
+        dirty = true;
+    }
+
+    bool isDirty() const { return dirty; }
+    void markDirty() { dirty = true; }
+    void markClean() { dirty = false; }
+
+    // O(1) through the set's id index; nullptr when the exam has no such question
+    shared_ptr<const Question> getQuestion(int questionID) const {
+        size_t slot = questions->slotOf(questionID);
+        return slot != QuestionSet::npos ? (*questions)[slot] : nullptr;
+    }
+
+    // Answer key for the current set, compiled on first use after an edit
+    shared_ptr<const AnswerKey> getAnswerKey() const {
+        if (!answerKey) answerKey = make_shared<const AnswerKey>(questions);
+        return answerKey;
+    }
+
+    map<int, bool> checkAnswers(const map<int, uint8_t>& choices, const map<int, string>& texts) const {
         map<int, bool> results;
-        for (const auto& q : questions) {
-            auto it = userAnswers.find(q->getQuestionID());
-            if (it != userAnswers.end()) {
-                results[q->getQuestionID()] = q->checkAnswer(it->second);
-            } else {
-                results[q->getQuestionID()] = false;
-            }
-        }
+        shared_ptr<const AnswerKey> key = getAnswerKey();
+        for (const auto& q : *questions)
+            results[q->getQuestionID()] = key->isCorrect(q->getQuestionID(), choices, texts);
         return results;
     }
 
     json toJson() const {
         json jQuestions = json::array();
-        for (const auto& q : questions)
+        for (const auto& q : *questions)
             jQuestions.push_back(q->toJson());
 
-        return {
+        json jExam = {
             {"examID", examID},
             {"subject", subject},
             {"duration", duration},
+            {"version", version},
             {"questions", jQuestions}
         };
+        if (randomized)
+            jExam["variants"] = {{"drawCount", drawCount}, {"salt", variantSalt}};
+        return jExam;
     }
 
     void loadFromJson(const json& jExam) {
         examID = jExam["examID"];
         subject = jExam["subject"];
         duration = jExam["duration"];
-        questions.clear();
+        QuestionSet::Items loaded;
         for (auto& jQ : jExam["questions"]) {
-            unique_ptr<Question> q;
+            shared_ptr<const Question> q;
             if (jQ["type"] == "MCQ") {
-                q = make_unique<MCQ>(jQ["questionID"], jQ["questionText"], 
-                                   jQ["answer"], jQ["options"].get<vector<string>>());
+                vector<string> options = jQ["options"].get<vector<string>>();
+                // Same bound as addMCQQuestion/importQuestions: options are named by
+                // one letter each and the compiled pack refuses anything larger
+                if (options.size() < 2 || options.size() > MCQ::MAX_OPTIONS) {
+                    cout << "Skipping question " << jQ["questionID"] << " of exam " << examID << ": an MCQ needs between 2 and "
+                         << MCQ::MAX_OPTIONS << " options, found " << options.size() << endl;
+                    continue;
+                }
+                // Older files stored the answer as option text (or a letter)
+                int correct = jQ["answer"].is_number()
+                    ? jQ["answer"].get<int>()
+                    : MCQ::resolveChoice(options, jQ["answer"].get<string>());
+                q = make_shared<const MCQ>(jQ["questionID"], jQ["questionText"], correct, move(options));
+            } else if (jQ["type"] == "TrueFalse") {
+                q = make_shared<const TrueFalse>(jQ["questionID"], jQ["questionText"], jQ["answer"].get<bool>());
+            } else if (jQ["type"] == "MultiSelect") {
+                if (jQ["options"].size() < 2 || jQ["options"].size() > MultiSelect::MAX_OPTIONS) {
+                    cout << "Skipping question " << jQ["questionID"] << " of exam " << examID << ": a MultiSelect needs between 2 and "
+                         << MultiSelect::MAX_OPTIONS << " options, found " << jQ["options"].size() << endl;
+                    continue;
+                }
+                uint64_t mask = 0;
+                for (const auto& index : jQ["answer"])
+                    if (index.get<int>() >= 0 && index.get<size_t>() < MultiSelect::MAX_OPTIONS) mask |= 1ull << index.get<int>();
+                q = make_shared<const MultiSelect>(jQ["questionID"], jQ["questionText"], mask,
+                                                   jQ["options"].get<vector<string>>());
+            } else if (jQ["type"] == "Numeric") {
+                q = make_shared<const Numeric>(jQ["questionID"], jQ["questionText"], jQ["answer"].get<double>(),
+                                               jQ.value("absTolerance", 0.0), jQ.value("relTolerance", 0.0));
             } else {
-                q = make_unique<Descriptive>(jQ["questionID"], jQ["questionText"], jQ["answer"]);
+                q = make_shared<const Descriptive>(jQ["questionID"], jQ["questionText"], jQ["answer"]);
             }
-            questions.push_back(move(q));
+            loaded.push_back(move(q));
         }
+        publish(move(loaded));
+        version = jExam.value("version", 1);  // older shards predate version ids
+        randomized = jExam.contains("variants");
+        drawCount = randomized ? jExam["variants"].value("drawCount", 0) : 0;
+        variantSalt = randomized ? jExam["variants"].value("salt", uint64_t(0)) : 0;
     }
 
     friend ostream& operator<<(ostream& out, const Exam& exam) {
         out << "Exam ID: " << exam.examID << ", Subject: " << exam.subject 
             << ", Duration: " << exam.duration << " mins\n";
-        for (const auto& q : exam.questions)
+        for (const auto& q : *exam.questions)
             q->displayQuestion();
         return out;
     }
 };
 
-class ExamStatistics {
+// Compiled, read-only image of one exam (exams/exam_<id>.pack), opened with mmap.
+// Layout: Header | Record[count] in exam order | IdSlot[count] sorted by id |
+// OptionRef[optionCount] | string pool (UTF-8, not terminated).
+// QuestionViews point into the mapping, so showing a question allocates
+// nothing; every session of an exam shares one mapping and its answer key.
+// Exam::toJson()/loadFromJson() stay the import/export format.
+class ExamImage {
 public:
-    void analyzeExam(const Exam& exam) {
-        cout << "Analyzing exam ID: " << exam.getExamID() << endl;
-    }
-};
+    static const uint32_t MAGIC = 0x314D5845;  // "EXM1" read as little-endian
+    static const uint32_t VERSION = 4;
+    static const uint8_t MCQ_TYPE = 0;
+    static const uint8_t TEXT_TYPE = 1;        // answered with text, compared as-is
+    static const uint8_t TRUE_FALSE_TYPE = 2;  // options "True"/"False", graded as a choice
+    static const uint8_t MULTI_SELECT_TYPE = 3;
+    static const uint8_t NUMERIC_TYPE = 4;
 
-template <typename T>
-class ExamContainer {
-    map<int, T> exams;
-public:
-    void addExam(T&& exam) {
-        exams.emplace(exam.getExamID(), move(exam));
-    }
+    struct Header {
+        uint32_t magic;
+        uint32_t version;
+        int32_t examID;
+        int32_t duration;
+        uint32_t count;
+        uint32_t optionCount;
+        uint32_t subjectOffset, subjectLength;
+        uint64_t stringsSize;
+        uint32_t randomized;     // 1 when students get their own variant
+        uint32_t drawCount;      // questions per variant, 0 = all
+        uint64_t variantSalt;
+        int32_t examVersion;     // Exam::getVersion() of the exam it was built from
+        uint32_t reserved;
+    };
+    struct Record {
+        int32_t questionID;
+        uint8_t type;
+        uint8_t correctOption;   // MCQ and True/False only
+        uint16_t optionCount;
+        uint32_t firstOption;    // index into the OptionRef table
+        uint32_t textOffset, textLength;
+        uint32_t answerOffset, answerLength;   // expected text; shown as the correct answer
+        uint32_t reserved;
+        uint64_t correctMask;    // MULTI_SELECT_TYPE
+        double value, tolerance; // NUMERIC_TYPE: right when |answer - value| <= tolerance
+    };
+    struct IdSlot {
+        int32_t questionID;
+        uint32_t index;
+    };
+    struct OptionRef {
+        uint32_t offset, length;
+    };
 
-    void removeExam(int id) {
-        exams.erase(id);
-    }
+    class QuestionView {
+        const ExamImage* image;
+        const Record* record;
+    public:
+        QuestionView(const ExamImage* img = nullptr, const Record* rec = nullptr) : image(img), record(rec) {}
 
-    const map<int, T>& getExams() const {
-        return exams;
-    }
+        int getQuestionID() const { return record->questionID; }
+        uint8_t getType() const { return record->type; }
+        bool isMCQ() const { return record->type == MCQ_TYPE; }
+        // Answered by picking one option (MCQ, True/False): stored as a choice byte
+        bool isChoice() const { return record->type == MCQ_TYPE || record->type == TRUE_FALSE_TYPE; }
+        uint8_t getCorrectOption() const { return record->correctOption; }
+        uint64_t getCorrectMask() const { return record->correctMask; }
+        double getValue() const { return record->value; }
+        double getTolerance() const { return record->tolerance; }
+        string_view getText() const { return image->text(record->textOffset, record->textLength); }
+        string_view getAnswer() const { return image->text(record->answerOffset, record->answerLength); }
+        size_t getOptionCount() const { return record->optionCount; }
+        string_view getOption(size_t i) const {
+            const OptionRef& ref = image->optionRefs[record->firstOption + i];
+            return image->text(ref.offset, ref.length);
+        }
 
-    T& getExam(int id) {
-        auto it = exams.find(id);
-        if (it == exams.end())
-            throw ExamException("Exam ID not found in container");
-        return it->second;
-    }
+        // `order` (optional) maps shown positions to option indices, as built
+        // by ExamVariant::optionOrder; letters refer to shown positions.
 
-    bool hasExam(int id) const {
-        return exams.find(id) != exams.end();
-    }
-};
+        // Same rules as MCQ::resolveChoice: exact option text, else a letter.
+        // Returns the original option index
+        int resolveChoice(string_view input, const uint8_t* order = nullptr) const {
+            if (record->type == TRUE_FALSE_TYPE) return TrueFalse::parseChoice(input);
+            for (size_t i = 0; i < getOptionCount(); ++i)
+                if (getOption(i) == input) return static_cast<int>(i);
+            if (input.size() == 1 && isalpha(static_cast<unsigned char>(input[0]))) {
+                size_t shown = toupper(static_cast<unsigned char>(input[0])) - 'A';
+                if (shown < getOptionCount()) return order ? order[shown] : static_cast<int>(shown);
+            }
+            return -1;
+        }
 
-class ExamManager {
-private:
-    static inline ExamManager* instance = nullptr;  // Fixed: inline static member
-    
-    ExamContainer<Exam> container;
-    int currentExamID = 1000;
-    int currentQuestionID = 1;
+        // Credit for a text answer, 0..1 (partial only for MultiSelect); parsed in place
+        double creditFor(string_view answer) const {
+            switch (record->type) {
+            case MULTI_SELECT_TYPE: {
+                uint64_t selected;
+                return MultiSelect::parseSelection(answer, getOptionCount(), selected)
+                    ? MultiSelect::credit(selected, record->correctMask) : 0;
+            }
+            case NUMERIC_TYPE: {
+                double number;
+                return Numeric::parse(answer, number) && Numeric::within(number, record->value, record->tolerance) ? 1 : 0;
+            }
+            default:
+                return answer == getAnswer() ? 1 : 0;
+            }
+        }
+        bool checkText(const string& answer) const { return creditFor(answer) == 1; }
 
-    ExamManager() = default;
-    ExamManager(const ExamManager&) = delete;
-    ExamManager& operator=(const ExamManager&) = delete;
+        // Whether a text answer can be graded at all (option letters, a number)
+        bool acceptsText(string_view answer) const {
+            uint64_t selected;
+            double number;
+            if (record->type == MULTI_SELECT_TYPE) return MultiSelect::parseSelection(answer, getOptionCount(), selected);
+            if (record->type == NUMERIC_TYPE) return Numeric::parse(answer, number);
+            return true;
+        }
 
-public:
-    static ExamManager* getInstance() {
-        if (!instance)
-            instance = new ExamManager();
-        return instance;
-    }
+        void printChoice(ostream& out, uint8_t choice, const uint8_t* order = nullptr) const {
+            if (choice >= getOptionCount()) {
+                out << "-";
+                return;
+            }
+            size_t shown = order ? std::find(order, order + getOptionCount(), choice) - order : choice;
+            out << char('A' + shown) << ") " << getOption(choice);
+        }
 
-    int getCurrentExamID() const {
-        return currentExamID;
-    }
+        // Same output as each Question::displayQuestion
+        void displayQuestion(const uint8_t* order = nullptr) const {
+            cout << "Q" << getQuestionID() << ": " << getText();
+            switch (record->type) {
+            case MCQ_TYPE: break;
+            case TRUE_FALSE_TYPE: cout << " [True/False]"; break;
+            case MULTI_SELECT_TYPE: cout << " [Select all that apply]"; break;
+            case NUMERIC_TYPE: cout << " [Numeric]" << endl; return;
+            default: cout << " [Descriptive]" << endl; return;
+            }
+            cout << endl;
+            for (size_t i = 0; i < getOptionCount(); ++i)
+                cout << char('A' + i) << ") " << getOption(order ? order[i] : i) << endl;
+        }
+    };
 
-    // CONCEPT: Function Overloading
-    int createExam(string subject, int duration) {
-        int examID = currentExamID++;
-        container.addExam(Exam(examID, subject, duration));
-        return examID;
-    }
-    
-    int createExam(int teacherID, string subject, int duration) {
-        int examID = currentExamID++;
-        container.addExam(Exam(examID, subject, duration));
-        return examID;
-    }
+    ExamImage() = default;
+    ExamImage(const ExamImage&) = delete;
+    ExamImage& operator=(const ExamImage&) = delete;
+    ~ExamImage() { close(); }
 
-    int addQuestion(int examID, string questionText, string type, string answer) {
-        Exam& exam = container.getExam(examID);
-        int qID = currentQuestionID++;
-        if (type == "MCQ") {
-            vector<string> options;
-            string opt;
-            cin.ignore();
-            cout << "Enter 4 options:\n";
-            for (int i = 0; i < 4; ++i) {
-                cout << "Option " << char('A' + i) << ": ";
-                getline(cin, opt);
-                options.push_back(opt);
+    // Serializes an exam into an in-memory image (written to disk by the caller)
+    static string build(const Exam& exam) {
+        vector<Record> records;
+        vector<OptionRef> options;
+        string pool;
+        auto append = [&pool](const string& s, uint32_t& offset, uint32_t& length) {
+            offset = static_cast<uint32_t>(pool.size());
+            length = static_cast<uint32_t>(s.size());
+            pool += s;
+        };
+
+        Header header{};
+        header.magic = MAGIC;
+        header.version = VERSION;
+        header.examID = exam.getExamID();
+        header.duration = exam.getDuration();
+        header.randomized = exam.isRandomized() ? 1 : 0;
+        header.drawCount = static_cast<uint32_t>(exam.getDrawCount());
+        header.variantSalt = exam.getVariantSalt();
+        header.examVersion = exam.getVersion();
+        append(exam.getSubject(), header.subjectOffset, header.subjectLength);
+
+        for (const auto& q : *exam.getQuestions()) {
+            Record record{};
+            record.questionID = q->getQuestionID();
+            append(q->getQuestionText(), record.textOffset, record.textLength);
+            auto appendOptions = [&](const vector<string>& texts) {
+                record.firstOption = static_cast<uint32_t>(options.size());
+                for (const string& option : texts) {
+                    OptionRef ref;
+                    append(option, ref.offset, ref.length);
+                    options.push_back(ref);
+                }
+                record.optionCount = static_cast<uint16_t>(texts.size());
+            };
+            record.correctOption = MCQ::NO_KEY;
+            if (const MCQ* mcq = dynamic_cast<const MCQ*>(q.get())) {
+                record.type = MCQ_TYPE;
+                record.correctOption = mcq->getCorrectOption();
+                appendOptions(mcq->getOptions());
+            } else if (const TrueFalse* trueFalse = dynamic_cast<const TrueFalse*>(q.get())) {
+                record.type = TRUE_FALSE_TYPE;
+                record.correctOption = trueFalse->getCorrectOption();
+                appendOptions(TrueFalse::options());
+            } else if (const MultiSelect* multi = dynamic_cast<const MultiSelect*>(q.get())) {
+                record.type = MULTI_SELECT_TYPE;
+                record.correctMask = multi->getCorrectMask();
+                appendOptions(multi->getOptions());
+                append(q->getCorrectAnswer(), record.answerOffset, record.answerLength);
+            } else if (const Numeric* numeric = dynamic_cast<const Numeric*>(q.get())) {
+                record.type = NUMERIC_TYPE;
+                record.value = numeric->getValue();
+                record.tolerance = numeric->getTolerance();
+                append(q->getCorrectAnswer(), record.answerOffset, record.answerLength);
+            } else {
+                record.type = TEXT_TYPE;
+                append(q->getCorrectAnswer(), record.answerOffset, record.answerLength);
             }
-            exam.addQuestion(make_unique<MCQ>(qID, questionText, answer, options));
-        } else {
-            exam.addQuestion(make_unique<Descriptive>(qID, questionText, answer));
+            records.push_back(record);
         }
-        return qID;
-    }
+        header.count = static_cast<uint32_t>(records.size());
+        header.optionCount = static_cast<uint32_t>(options.size());
+        header.stringsSize = pool.size();
 
-    int addMCQuestion(int examID, string questionText, string answer, vector<string> options) {
-        Exam& exam = container.getExam(examID);
-        int qID = currentQuestionID++;
-        exam.addQuestion(make_unique<MCQ>(qID, questionText, answer, options));
-        return qID;
-    }
+        vector<IdSlot> ids(records.size());
+        for (size_t i = 0; i < records.size(); ++i)
+            ids[i] = {records[i].questionID, static_cast<uint32_t>(i)};
+        stable_sort(ids.begin(), ids.end(), [](const IdSlot& a, const IdSlot& b) { return a.questionID < b.questionID; });
 
-    int addDescriptiveQuestion(int examID, string questionText, string answer) {
-        Exam& exam = container.getExam(examID);
-        int qID = currentQuestionID++;
-        exam.addQuestion(make_unique<Descriptive>(qID, questionText, answer));
-        return qID;
+        string image;
+        image.reserve(sizeof(Header) + records.size() * (sizeof(Record) + sizeof(IdSlot)) +
+                      options.size() * sizeof(OptionRef) + pool.size());
+        image.append(reinterpret_cast<const char*>(&header), sizeof(Header));
+        image.append(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(Record));
+        image.append(reinterpret_cast<const char*>(ids.data()), ids.size() * sizeof(IdSlot));
+        image.append(reinterpret_cast<const char*>(options.data()), options.size() * sizeof(OptionRef));
+        image += pool;
+        return image;
     }
 
-    void removeQuestion(int examID, int questionID) {
-        Exam& exam = container.getExam(examID);
-        exam.removeQuestion(questionID);
-    }
+    bool open(const filesystem::path& path);   // false if missing, truncated or another version
+    static int readVersion(const filesystem::path& path);  // exam version from the header alone; -1 if unreadable
+    void close();
+    bool isOpen() const { return data != nullptr; }
 
-    void modifyQuestion(int examID, int questionID, string newText) {
-        Exam& exam = container.getExam(examID);
-        exam.modifyQuestion(questionID, newText);
-    }
+    int getExamID() const { return header ? header->examID : 0; }
+    int getDuration() const { return header ? header->duration : 0; }
+    int getVersion() const { return header ? header->examVersion : -1; }
+    string_view getSubject() const { return header ? text(header->subjectOffset, header->subjectLength) : string_view(); }
+    size_t size() const { return header ? header->count : 0; }
+    bool isRandomized() const { return header && header->randomized; }
+    size_t getDrawCount() const { return header ? header->drawCount : 0; }
+    uint64_t getVariantSalt() const { return header ? header->variantSalt : 0; }
+    QuestionView at(size_t index) const { return QuestionView(this, &records[index]); }
 
-    void deleteExam(int examID) {
-        container.removeExam(examID);
+    // Binary search over the id table
+    bool find(int questionID, QuestionView& out) const {
+        const IdSlot* first = ids;
+        const IdSlot* last = ids + size();
+        const IdSlot* it = lower_bound(first, last, questionID,
+                                       [](const IdSlot& slot, int id) { return slot.questionID < id; });
+        if (it == last || it->questionID != questionID) return false;
+        out = at(it->index);
+        return true;
     }
 
-    void displayExam(int examID) const {
-        const Exam& exam = container.getExams().at(examID);
-        exam.displayExam();
-    }
+    // Compiled once when the image is opened; valid until close()
+    const AnswerKey& getAnswerKey() const { return *answerKey; }
 
-    void displayAllExams() const {
-        for (const auto& [id, exam] : container.getExams())
-            cout << exam << endl;
-    }
+private:
+    const char* data = nullptr;
+    size_t length = 0;
+    const Header* header = nullptr;
+    const Record* records = nullptr;
+    const IdSlot* ids = nullptr;
+    const OptionRef* optionRefs = nullptr;
+    const char* strings = nullptr;
+    unique_ptr<const AnswerKey> answerKey;
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#endif
+
+    string_view text(uint32_t offset, uint32_t len) const { return string_view(strings + offset, len); }
+    bool inPool(uint32_t offset, uint32_t len) const { return uint64_t(offset) + len <= header->stringsSize; }
+    bool validate();
+};
+
+// The shared image for exams whose pack could not be opened
+inline const shared_ptr<const ExamImage>& emptyExamImage() {
+    static const shared_ptr<const ExamImage> empty = make_shared<const ExamImage>();
+    return empty;
+}
 
-    vector<shared_ptr<Question>> getExamQuestions(int examID) const {
-        const Exam& exam = container.getExams().at(examID);
-        return exam.getQuestionsCopy();
+inline bool ExamImage::open(const filesystem::path& path) {
+    close();
+#ifdef _WIN32
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart < (LONGLONG)sizeof(Header)) {
+        CloseHandle(file);
+        return false;
     }
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) {
+        CloseHandle(file);
+        return false;
+    }
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    fileHandle = file;
+    mappingHandle = mapping;
+    data = static_cast<const char*>(view);
+    length = static_cast<size_t>(fileSize.QuadPart);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(Header)) {
+        ::close(fd);
+        return false;
+    }
+    void* view = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);  // the mapping keeps the file alive, even after a newer pack replaces it
+    if (view == MAP_FAILED) return false;
+    data = static_cast<const char*>(view);
+    length = static_cast<size_t>(st.st_size);
+#endif
 
-    map<int, bool> checkExamAnswers(int examID, const map<int, string>& userAnswers) const {
-        const Exam& exam = container.getExams().at(examID);
-        return exam.checkAnswers(userAnswers);
+    header = reinterpret_cast<const Header*>(data);
+    if (!validate()) {
+        close();
+        return false;
     }
+    answerKey = make_unique<const AnswerKey>(*this);
+    return true;
+}
 
-    Exam* getExam(int examID) {
-        try {
-            Exam& exam = container.getExam(examID);
-            return &exam;
-        } catch (const ExamException&) {
+// Reads only the header, so callers can tell a pack's version without mapping it
+inline int ExamImage::readVersion(const filesystem::path& path) {
+    ifstream in(path, ios::binary);
+    Header h{};
+    if (!in.read(reinterpret_cast<char*>(&h), sizeof(Header))) return -1;
+    return h.magic == MAGIC && h.version == VERSION ? h.examVersion : -1;
+}
+
+// Checks every offset in the file before any view is handed out
+inline bool ExamImage::validate() {
+    if (header->magic != MAGIC || header->version != VERSION) return false;
+    size_t recordsBytes = size_t(header->count) * sizeof(Record);
+    size_t idsBytes = size_t(header->count) * sizeof(IdSlot);
+    size_t optionsBytes = size_t(header->optionCount) * sizeof(OptionRef);
+    // Subtract rather than add: a sum with a corrupt stringsSize could wrap around
+    size_t fixedBytes = sizeof(Header) + recordsBytes + idsBytes + optionsBytes;
+    if (fixedBytes > length || header->stringsSize != length - fixedBytes) return false;
+
+    records = reinterpret_cast<const Record*>(data + sizeof(Header));
+    ids = reinterpret_cast<const IdSlot*>(data + sizeof(Header) + recordsBytes);
+    optionRefs = reinterpret_cast<const OptionRef*>(data + sizeof(Header) + recordsBytes + idsBytes);
+    strings = data + sizeof(Header) + recordsBytes + idsBytes + optionsBytes;
+
+    if (!inPool(header->subjectOffset, header->subjectLength)) return false;
+    for (size_t i = 0; i < header->count; ++i) {
+        const Record& r = records[i];
+        if (!inPool(r.textOffset, r.textLength) || !inPool(r.answerOffset, r.answerLength)) return false;
+        if (uint64_t(r.firstOption) + r.optionCount > header->optionCount) return false;
+        if (r.type > NUMERIC_TYPE || (r.type == TRUE_FALSE_TYPE && r.optionCount != 2) ||
+            (r.type == MULTI_SELECT_TYPE && r.optionCount > MultiSelect::MAX_OPTIONS)) return false;
+        // Options are named A-Z, and sessions shuffle them in a fixed 256-entry
+        // array whose top entries are sentinels
+        if (r.type == MCQ_TYPE && (r.optionCount < 2 || r.optionCount > MCQ::MAX_OPTIONS)) return false;
+        if (ids[i].index >= header->count || (i > 0 && ids[i - 1].questionID > ids[i].questionID)) return false;
+    }
+    for (size_t i = 0; i < header->optionCount; ++i)
+        if (!inPool(optionRefs[i].offset, optionRefs[i].length)) return false;
+    return true;
+}
+
+inline void ExamImage::close() {
+    answerKey.reset();
+    if (data) {
+#ifdef _WIN32
+        UnmapViewOfFile(data);
+        CloseHandle(mappingHandle);
+        CloseHandle(fileHandle);
+        mappingHandle = fileHandle = nullptr;
+#else
+        munmap(const_cast<char*>(data), length);
+#endif
+    }
+    data = nullptr;
+    length = 0;
+    header = nullptr;
+    records = nullptr;
+    ids = nullptr;
+    optionRefs = nullptr;
+    strings = nullptr;
+}
+
+// One student's arrangement of an exam: questions drawn from the pool, in the
+// order shown, with every MCQ's options shuffled. Only the seed is stored and
+// the index arrays are recomputed from it, so a variant costs 8 bytes however
+// large the cohort. Choices are recorded as original option indices, so the
+// answer key grades every variant unchanged.
+class ExamVariant {
+    uint64_t seed = 0;   // 0 = the exam as written
+
+    static uint64_t next(uint64_t& state) {   // splitmix64: same sequence on every platform
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+    template <typename T>
+    static void shuffle(T* items, size_t n, uint64_t state) {
+        for (size_t i = n; i > 1; --i) swap(items[i - 1], items[next(state) % i]);
+    }
+
+public:
+    ExamVariant() = default;
+    explicit ExamVariant(uint64_t s) : seed(s) {}
+
+    // The same student always gets the same variant of an exam
+    static ExamVariant forStudent(const ExamImage& image, int studentID) {
+        if (!image.isRandomized()) return ExamVariant();
+        uint64_t state = image.getVariantSalt() ^
+                         (uint64_t(uint32_t(image.getExamID())) << 32 | uint32_t(studentID));
+        return ExamVariant(next(state) | 1);
+    }
+
+    uint64_t getSeed() const { return seed; }
+    bool isShuffled() const { return seed != 0; }
+
+    // Questions this student answers (drawn from the pool when the exam sets a draw count)
+    size_t questionCount(const ExamImage& image) const {
+        size_t draw = image.getDrawCount();
+        return seed && draw && draw < image.size() ? draw : image.size();
+    }
+
+    // Slots of image.at() in the order shown
+    vector<uint32_t> questionOrder(const ExamImage& image) const {
+        vector<uint32_t> order(image.size());
+        for (size_t i = 0; i < order.size(); ++i) order[i] = static_cast<uint32_t>(i);
+        if (seed) {
+            shuffle(order.data(), order.size(), seed);
+            order.resize(questionCount(image));
+        }
+        return order;
+    }
+
+    bool includes(const ExamImage& image, int questionID) const {
+        if (questionCount(image) == image.size()) return true;
+        for (uint32_t slot : questionOrder(image))
+            if (image.at(slot).getQuestionID() == questionID) return true;
+        return false;
+    }
+
+    // Fills order[shown position] = option index; nullptr when options keep their order
+    const uint8_t* optionOrder(const ExamImage::QuestionView& question, uint8_t (&order)[256]) const {
+        if (!seed || !question.isMCQ()) return nullptr;
+        size_t n = question.getOptionCount();
+        if (n > size(order)) return nullptr;  // cannot be shuffled in place; show it unshuffled
+        for (size_t i = 0; i < n; ++i) order[i] = static_cast<uint8_t>(i);
+        shuffle(order, n, seed ^ (uint64_t(uint32_t(question.getQuestionID())) * 0xD6E8FEB86659FD93ull));
+        return order;
+    }
+};
+
+inline AnswerKey::AnswerKey(const ExamImage& image) {
+    for (size_t i = 0; i < image.size(); ++i) {
+        ExamImage::QuestionView q = image.at(i);
+        if (q.isChoice()) {
+            slotOf[q.getQuestionID()] = static_cast<uint32_t>(mcqCodes.size());
+            slotQuestions.push_back(q.getQuestionID());
+            mcqCodes.push_back(q.getCorrectOption());
+            continue;
+        }
+        TextSlot slot;
+        slot.questionID = q.getQuestionID();
+        if (q.getType() == ExamImage::MULTI_SELECT_TYPE) {
+            slot.kind = SlotKind::Selection;
+            slot.mask = q.getCorrectMask();
+            slot.optionCount = static_cast<uint16_t>(q.getOptionCount());
+        } else if (q.getType() == ExamImage::NUMERIC_TYPE) {
+            slot.kind = SlotKind::Number;
+            slot.value = q.getValue();
+            slot.tolerance = q.getTolerance();
+        } else {
+            slot.expected = q.getAnswer();
+        }
+        textSlots.push_back(slot);
+    }
+    indexTextSlots();
+}
+
+// Item analysis over graded answer sheets. Sheets are streamed in once and
+// kept column-wise (one byte per sheet per question, in answer-key slot
+// order), so every statistic comes from one sequential pass down each column:
+//   difficulty      p-value: share of the students given the item who got it right
+//   discrimination  point-biserial correlation between the item and the total score
+//   distractors     how often each MCQ option was picked (plus blank/invalid)
+//   reliability     KR-20, i.e. Cronbach's alpha for right/wrong items
+class ExamStatistics {
+public:
+    static constexpr uint8_t NOT_PRESENTED = 0xFC;   // item not in the student's variant
+    static_assert(NOT_PRESENTED >= MCQ::MAX_OPTIONS, "NOT_PRESENTED must not be a valid MCQ option index");
+    static constexpr uint8_t TEXT_WRONG = 0;         // column codes for text questions
+    static constexpr uint8_t TEXT_RIGHT = 1;
+
+    struct ItemStatistics {
+        int questionID = 0;
+        bool isMCQ = false;           // a choice item: MCQ or True/False
+        uint32_t presented = 0;       // sheets that had the item
+        uint32_t blank = 0;
+        uint32_t invalid = 0;         // MCQ answers that named no option
+        double difficulty = 0;
+        double discrimination = 0;    // 0 when undefined (everyone right or wrong)
+        vector<uint32_t> optionCounts;
+    };
+    struct ExamAnalysis {
+        int examID = 0;
+        size_t sheets = 0;
+        double meanScore = 0;         // correct answers per sheet
+        double scoreStdDev = 0;
+        double reliability = 0;
+        bool hasReliability = false;  // needs 2+ items, score variance, and no drawn pools
+        vector<ItemStatistics> items;
+    };
+
+    explicit ExamStatistics(const Exam& exam) : examID(exam.getExamID()) {
+        shared_ptr<const AnswerKey> compiled = exam.getAnswerKey();
+        key = compiled.get();
+        source = compiled;
+        optionCounts.assign(key->mcqCount(), 0);
+        for (size_t slot = 0; slot < key->mcqCount(); ++slot) {
+            shared_ptr<const Question> question = exam.getQuestion(key->questionAt(slot));
+            if (const MCQ* mcq = dynamic_cast<const MCQ*>(question.get()))
+                optionCounts[slot] = static_cast<uint16_t>(mcq->getOptions().size());
+            else if (dynamic_cast<const TrueFalse*>(question.get()))
+                optionCounts[slot] = 2;
+        }
+        columns.resize(key->size());
+    }
+
+    explicit ExamStatistics(shared_ptr<const ExamImage> examImage)
+        : key(&examImage->getAnswerKey()), image(examImage.get()), examID(examImage->getExamID()) {
+        source = move(examImage);
+        optionCounts.assign(key->mcqCount(), 0);
+        for (size_t slot = 0; slot < key->mcqCount(); ++slot) {
+            ExamImage::QuestionView question;
+            if (image->find(key->questionAt(slot), question))
+                optionCounts[slot] = static_cast<uint16_t>(question.getOptionCount());
+        }
+        columns.resize(key->size());
+    }
+
+    void reserve(size_t sheets) {
+        for (auto& column : columns) column.reserve(sheets);
+        totals.reserve(sheets);
+    }
+
+    // One graded sheet as the session stores it; with a variant (image-built
+    // statistics only), items outside the student's draw are NOT_PRESENTED
+    void addSheet(const map<int, uint8_t>& choices, const map<int, string>& texts,
+                  const ExamVariant& variant = ExamVariant()) {
+        row.resize(key->size());
+        key->packMCQ(choices, row.data());
+        for (size_t slot = key->mcqCount(); slot < key->size(); ++slot) {
+            int check = key->checkText(slot, texts);
+            row[slot] = check < 0 ? AnswerKey::UNANSWERED : check ? TEXT_RIGHT : TEXT_WRONG;
+        }
+        if (image && variant.questionCount(*image) < image->size()) {
+            vector<uint8_t> drawn(key->size(), 0);
+            for (uint32_t slot : variant.questionOrder(*image)) {
+                size_t keySlot = key->slotFor(image->at(slot).getQuestionID());
+                if (keySlot != AnswerKey::npos) drawn[keySlot] = 1;
+            }
+            for (size_t slot = 0; slot < row.size(); ++slot)
+                if (!drawn[slot]) row[slot] = NOT_PRESENTED;
+        }
+        addPackedSheet(row.data());
+    }
+
+    // codes: one byte per answer-key slot; the option index (or
+    // AnswerKey::UNANSWERED / MCQ::INVALID_CHOICE) for MCQ slots, then
+    // TEXT_RIGHT / TEXT_WRONG / UNANSWERED for text slots; NOT_PRESENTED anywhere
+    void addPackedSheet(const uint8_t* codes) {
+        size_t mcqCount = key->mcqCount();
+        uint16_t total = static_cast<uint16_t>(AnswerKey::countEqual(key->codes(), codes, mcqCount));
+        for (size_t slot = mcqCount; slot < columns.size(); ++slot) total += codes[slot] == TEXT_RIGHT;
+        for (size_t slot = 0; slot < columns.size(); ++slot) {
+            columns[slot].push_back(codes[slot]);
+            if (codes[slot] == NOT_PRESENTED) allPresented = false;
+        }
+        totals.push_back(total);
+    }
+
+    size_t sheetCount() const { return totals.size(); }
+
+    ExamAnalysis analyzeExam() const {
+        ExamAnalysis analysis;
+        analysis.examID = examID;
+        analysis.sheets = totals.size();
+        if (totals.empty()) return analysis;
+
+        double sum = 0, sumSquares = 0;
+        for (uint16_t total : totals) {
+            sum += total;
+            sumSquares += double(total) * total;
+        }
+        double n = static_cast<double>(totals.size());
+        analysis.meanScore = sum / n;
+        double variance = max(0.0, sumSquares / n - analysis.meanScore * analysis.meanScore);
+        analysis.scoreStdDev = sqrt(variance);
+
+        double sumPQ = 0;
+        analysis.items.reserve(columns.size());
+        for (size_t slot = 0; slot < columns.size(); ++slot) {
+            ItemStatistics item = analyzeColumn(slot);
+            sumPQ += item.difficulty * (1 - item.difficulty);
+            analysis.items.push_back(move(item));
+        }
+        size_t k = columns.size();
+        analysis.hasReliability = allPresented && k > 1 && variance > 0;
+        if (analysis.hasReliability)
+            analysis.reliability = (double(k) / (k - 1)) * (1 - sumPQ / variance);
+        return analysis;
+    }
+
+    static void displayAnalysis(const ExamAnalysis& analysis, ostream& out = cout) {
+        out << "\n--- Item Analysis for Exam ID " << analysis.examID << " ---" << endl;
+        out << "Answer sheets: " << analysis.sheets << endl;
+        if (analysis.sheets == 0) return;
+        out << fixed << setprecision(2);
+        out << "Mean score: " << analysis.meanScore << " correct (std dev " << analysis.scoreStdDev << ")" << endl;
+        if (analysis.hasReliability) out << "Reliability (KR-20): " << analysis.reliability << endl;
+        else out << "Reliability (KR-20): n/a" << endl;
+        for (const auto& item : analysis.items) {
+            out << "Q" << item.questionID << ": difficulty " << item.difficulty
+                << ", discrimination " << item.discrimination;
+            if (item.blank) out << ", blank " << item.blank;
+            if (item.invalid) out << ", invalid " << item.invalid;
+            out << endl;
+            if (item.isMCQ && item.presented) {
+                out << "   options:";
+                for (size_t option = 0; option < item.optionCounts.size(); ++option)
+                    out << " " << char('A' + option) << "=" << 100.0 * item.optionCounts[option] / item.presented << "%";
+                out << endl;
+            }
+        }
+        out.unsetf(ios::floatfield);
+        out << setprecision(6);
+    }
+
+private:
+    shared_ptr<const void> source;   // keeps the key (and image) alive
+    const AnswerKey* key = nullptr;
+    const ExamImage* image = nullptr;
+    int examID;
+    vector<uint16_t> optionCounts;   // per MCQ slot
+    vector<vector<uint8_t>> columns; // per key slot, one code per sheet
+    vector<uint16_t> totals;         // correct answers per sheet
+    bool allPresented = true;
+    vector<uint8_t> row;             // reused by addSheet
+
+    ItemStatistics analyzeColumn(size_t slot) const {
+        ItemStatistics item;
+        item.questionID = key->questionAt(slot);
+        item.isMCQ = slot < key->mcqCount();
+        const uint8_t right = item.isMCQ ? key->codes()[slot] : TEXT_RIGHT;
+        const vector<uint8_t>& column = columns[slot];
+
+        uint32_t histogram[256] = {};
+        double n = 0, sumX = 0, sumSquares = 0, rightCount = 0, sumRight = 0;
+        for (size_t s = 0; s < column.size(); ++s) {
+            uint8_t code = column[s];
+            ++histogram[code];
+            if (code == NOT_PRESENTED) continue;
+            double x = totals[s];
+            bool correct = code == right;
+            n += 1;
+            sumX += x;
+            sumSquares += x * x;
+            rightCount += correct;
+            sumRight += correct ? x : 0;
+        }
+
+        item.presented = static_cast<uint32_t>(n);
+        item.blank = histogram[AnswerKey::UNANSWERED];
+        item.invalid = item.isMCQ ? histogram[MCQ::INVALID_CHOICE] : 0;
+        if (item.isMCQ) item.optionCounts.assign(histogram, histogram + optionCounts[slot]);
+        if (n == 0) return item;
+
+        double p = rightCount / n;
+        double mean = sumX / n;
+        double sd = sqrt(max(0.0, sumSquares / n - mean * mean));
+        item.difficulty = p;
+        if (rightCount > 0 && rightCount < n && sd > 0) {
+            double meanRight = sumRight / rightCount;
+            double meanWrong = (sumX - sumRight) / (n - rightCount);
+            item.discrimination = (meanRight - meanWrong) / sd * sqrt(p * (1 - p));
+        }
+        return item;
+    }
+};
+
+// Size-bounded LRU map. Values live in list nodes, so pointers to them stay
+// valid until that entry is evicted or erased.
+template <typename K, typename V>
+class LRUCache {
+    list<pair<K, V>> entries;   // most recently used first
+    unordered_map<K, typename list<pair<K, V>>::iterator> index;
+    size_t capacity;
+    size_t hits = 0, misses = 0, evictions = 0;
+
+public:
+    explicit LRUCache(size_t cap) : capacity(cap ? cap : 1) {}
+
+    // Counts a hit or a miss; a hit becomes the most recently used entry
+    V* get(const K& key) {
+        auto it = index.find(key);
+        if (it == index.end()) {
+            ++misses;
             return nullptr;
         }
+        ++hits;
+        entries.splice(entries.begin(), entries, it->second);
+        return &it->second->second;
     }
 
-    int getExamDuration(int examID) const {
-        const Exam& exam = container.getExams().at(examID);
-        return exam.getDuration();
+    V* peek(const K& key) {
+        auto it = index.find(key);
+        return it != index.end() ? &it->second->second : nullptr;
     }
 
-    string getExamSubject(int examID) const {
-        const Exam& exam = container.getExams().at(examID);
-        return exam.getSubject();
+    // Inserts as most recently used; evicted entries are handed to onEvict first
+    template <typename Evict>
+    V& put(const K& key, V&& value, Evict&& onEvict) {
+        auto it = index.find(key);
+        if (it != index.end()) {
+            it->second->second = move(value);
+            entries.splice(entries.begin(), entries, it->second);
+            return it->second->second;
+        }
+        while (entries.size() >= capacity) {
+            onEvict(entries.back().first, entries.back().second);
+            index.erase(entries.back().first);
+            entries.pop_back();
+            ++evictions;
+        }
+        entries.emplace_front(key, move(value));
+        index[key] = entries.begin();
+        return entries.front().second;
     }
 
-    void saveExamsToFile() const {
-        ofstream outFile("exams.json");
-        if (!outFile)
-            throw ExamException("Unable to open exams.json for writing");
+    bool erase(const K& key) {
+        auto it = index.find(key);
+        if (it == index.end()) return false;
+        entries.erase(it->second);
+        index.erase(it);
+        return true;
+    }
 
-        json j;
-        for (const auto& [id, exam] : container.getExams())
-            j.push_back(exam.toJson());
+    template <typename F>
+    void forEach(F&& visit) {
+        for (auto& [key, value] : entries) visit(key, value);
+    }
 
-        outFile << setw(4) << j;
-        outFile.close();
+    void clear() { entries.clear(); index.clear(); }
+    void setCapacity(size_t cap) { capacity = cap ? cap : 1; }
+    size_t size() const { return entries.size(); }
+    size_t getCapacity() const { return capacity; }
+    size_t getHits() const { return hits; }
+    size_t getMisses() const { return misses; }
+    size_t getEvictions() const { return evictions; }
+};
+
+// Inverted index over question text and MCQ options, across every exam.
+// Terms are lower-cased alphanumeric words (bytes of UTF-8 characters count
+// as letters; common stopwords are dropped). Each posting list holds the
+// sorted slots of the questions using that term, so a query intersects its
+// shortest lists first. Near duplicates are pairs whose term sets have a
+// Jaccard similarity over a threshold, found without comparing all pairs.
+class QuestionIndex {
+public:
+    struct Hit {
+        int examID;
+        int questionID;
+    };
+    struct DuplicatePair {
+        Hit first, second;
+        double similarity;
+    };
+
+    static vector<string> tokenize(const string& text) {
+        static const set<string> stopwords = {
+            "a", "an", "and", "are", "as", "at", "be", "by", "do", "does", "for", "from", "how", "in",
+            "is", "it", "of", "on", "or", "that", "the", "this", "to", "was", "what", "when", "which",
+            "who", "why", "with"};
+        vector<string> words;
+        string word;
+        for (size_t i = 0; i <= text.size(); ++i) {
+            unsigned char c = i < text.size() ? static_cast<unsigned char>(text[i]) : ' ';
+            if (isalnum(c) || c >= 0x80) {
+                word += static_cast<char>(tolower(c));
+            } else if (!word.empty()) {
+                if (!stopwords.count(word)) words.push_back(move(word));
+                word.clear();
+            }
+        }
+        return words;
     }
 
-    void loadExamsFromFile() {
-        ifstream inFile("exams.json");
-        if (!inFile)
-            throw ExamException("Unable to open exams.json for reading");
+    void add(int examID, const Question& question) {
+        remove(question.getQuestionID());
+        string text = question.getQuestionText();
+        if (const MCQ* mcq = dynamic_cast<const MCQ*>(&question)) {
+            for (const string& option : mcq->getOptions()) text += " " + option;
+        } else if (const MultiSelect* multi = dynamic_cast<const MultiSelect*>(&question)) {
+            for (const string& option : multi->getOptions()) text += " " + option;
+        }
+        Doc doc{examID, question.getQuestionID(), {}};
+        uint32_t signature[SIGNATURE_SIZE];
+        fill(signature, signature + SIGNATURE_SIZE, UINT32_MAX);
+        for (const string& word : tokenize(text)) {
+            auto [it, inserted] = termIDs.emplace(word, static_cast<uint32_t>(postings.size()));
+            if (inserted) postings.emplace_back();
+            doc.terms.push_back(it->second);
+            // Hashed from the word, not its term id, which compaction renumbers
+            uint64_t wordKey = hash<string>{}(word);
+            for (size_t row = 0; row < SIGNATURE_SIZE; ++row)
+                signature[row] = min(signature[row], static_cast<uint32_t>(mixHash(wordKey, row) >> 32));
+        }
+        sort(doc.terms.begin(), doc.terms.end());
+        doc.terms.erase(unique(doc.terms.begin(), doc.terms.end()), doc.terms.end());
+
+        uint32_t slot = static_cast<uint32_t>(docs.size());  // newest slot, so postings stay sorted
+        for (uint32_t term : doc.terms) postings[term].push_back(slot);
+        docs.push_back(move(doc));
+        signatures.insert(signatures.end(), signature, signature + SIGNATURE_SIZE);
+        docOf[question.getQuestionID()] = slot;
+    }
+
+    bool remove(int questionID) {
+        auto it = docOf.find(questionID);
+        if (it == docOf.end()) return false;
+        Doc& doc = docs[it->second];
+        for (uint32_t term : doc.terms) {
+            vector<uint32_t>& list = postings[term];
+            list.erase(lower_bound(list.begin(), list.end(), it->second));
+        }
+        doc.terms.clear();
+        doc.questionID = 0;   // slot stays empty until the next compaction
+        docOf.erase(it);
+        if (++deadSlots > COMPACT_MIN_DEAD && deadSlots > docOf.size()) compact();
+        return true;
+    }
+
+    void removeExam(int examID) {
+        vector<int> questionIDs;
+        for (const Doc& doc : docs)
+            if (doc.questionID && doc.examID == examID) questionIDs.push_back(doc.questionID);
+        for (int questionID : questionIDs) remove(questionID);
+    }
+
+    // Questions containing every term of the query, oldest first; returns how
+    // many match in total and appends up to limit of them to out
+    size_t search(const string& query, vector<Hit>& out, size_t limit) const {
+        vector<const vector<uint32_t>*> lists;
+        for (const string& word : tokenize(query)) {
+            auto it = termIDs.find(word);
+            if (it == termIDs.end()) return 0;
+            lists.push_back(&postings[it->second]);
+        }
+        if (lists.empty()) return 0;
+        sort(lists.begin(), lists.end(), [](auto* a, auto* b) { return a->size() < b->size(); });
+
+        size_t total = 0;
+        for (uint32_t slot : *lists[0]) {
+            bool inAll = true;
+            for (size_t i = 1; i < lists.size() && inAll; ++i)
+                inAll = binary_search(lists[i]->begin(), lists[i]->end(), slot);
+            if (!inAll) continue;
+            if (total++ < limit) out.push_back({docs[slot].examID, docs[slot].questionID});
+        }
+        return total;
+    }
+
+    // Pairs of questions with similarity >= threshold (0 < threshold <= 1),
+    // most similar first, at most limit of them. Candidates come from MinHash
+    // banding (LSH) over the signatures stored by add(): a pair at the
+    // threshold shares a band with probability >= 0.99, far less similar pairs
+    // almost never do; every candidate is then verified on its exact term
+    // sets, so reported pairs are never false. Bands are at least MIN_ROWS
+    // wide, so below about 0.37 recall drops rather than every pair sharing
+    // a one-hash bucket.
+    vector<DuplicatePair> nearDuplicates(double threshold, size_t limit) const {
+        const size_t hashes = SIGNATURE_SIZE;
+        size_t rows = hashes;   // most selective band width that still keeps 99% recall
+        while (rows > MIN_ROWS && 1 - pow(1 - pow(threshold, double(rows)), double(hashes / rows)) < 0.99) --rows;
+        const size_t bands = hashes / rows;
+
+        vector<DuplicatePair> pairs;
+        unordered_set<uint64_t> checked;             // (slot, slot) pairs already verified
+        vector<pair<uint64_t, uint32_t>> buckets;    // band key, doc slot
+        buckets.reserve(docOf.size());
+        for (size_t band = 0; band < bands; ++band) {
+            buckets.clear();
+            for (uint32_t slot = 0; slot < docs.size(); ++slot) {
+                if (docs[slot].terms.empty()) continue;
+                const uint32_t* signature = &signatures[size_t(slot) * SIGNATURE_SIZE];
+                uint64_t key = band;
+                for (size_t row = band * rows; row < (band + 1) * rows; ++row)
+                    key = mixHash(key ^ signature[row], hashes);
+                buckets.push_back({key, slot});
+            }
+            sort(buckets.begin(), buckets.end());
+            for (size_t first = 0; first < buckets.size();) {
+                size_t last = first;
+                while (last < buckets.size() && buckets[last].first == buckets[first].first) ++last;
+                for (size_t i = first; i < last; ++i) {
+                    for (size_t j = i + 1; j < last; ++j) {
+                        uint32_t x = buckets[i].second, y = buckets[j].second;
+                        if (!checked.insert(uint64_t(x) << 32 | y).second) continue;
+                        double similarity = jaccard(docs[x].terms, docs[y].terms);
+                        if (similarity >= threshold)
+                            pairs.push_back({{docs[x].examID, docs[x].questionID},
+                                             {docs[y].examID, docs[y].questionID}, similarity});
+                    }
+                }
+                first = last;
+            }
+        }
+        sort(pairs.begin(), pairs.end(), [](const DuplicatePair& a, const DuplicatePair& b) {
+            if (a.similarity != b.similarity) return a.similarity > b.similarity;
+            return a.first.questionID != b.first.questionID ? a.first.questionID < b.first.questionID
+                                                            : a.second.questionID < b.second.questionID;
+        });
+        if (pairs.size() > limit) pairs.resize(limit);
+        return pairs;
+    }
+
+    size_t size() const { return docOf.size(); }
+    size_t termCount() const { return termIDs.size(); }
+
+    void clear() {
+        termIDs.clear();
+        postings.clear();
+        docs.clear();
+        signatures.clear();
+        docOf.clear();
+        deadSlots = 0;
+    }
+
+private:
+    static const size_t COMPACT_MIN_DEAD = 64;
+    static const size_t SIGNATURE_SIZE = 64;   // MinHash values per doc
+    static const size_t MIN_ROWS = 2;          // narrowest LSH band nearDuplicates uses
+    struct Doc {
+        int examID;
+        int questionID;          // 0 once removed
+        vector<uint32_t> terms;  // sorted, unique term ids
+    };
+    unordered_map<string, uint32_t> termIDs;
+    vector<vector<uint32_t>> postings;   // term id -> sorted doc slots
+    vector<Doc> docs;
+    vector<uint32_t> signatures;         // SIGNATURE_SIZE per doc slot, computed once by add()
+    unordered_map<int, uint32_t> docOf;  // questionID -> doc slot
+    size_t deadSlots = 0;                // removed docs still holding a slot
+
+    // Drops removed slots and unused terms. Both are renumbered in their old
+    // order, so slots stay in insertion order and every list stays sorted.
+    void compact() {
+        vector<uint32_t> newTerm(postings.size(), UINT32_MAX);
+        uint32_t terms = 0;
+        for (uint32_t term = 0; term < postings.size(); ++term) {
+            if (postings[term].empty()) continue;
+            newTerm[term] = terms;
+            if (terms != term) postings[terms] = move(postings[term]);
+            ++terms;
+        }
+        postings.resize(terms);
+        for (auto it = termIDs.begin(); it != termIDs.end();) {
+            if (newTerm[it->second] == UINT32_MAX) {
+                it = termIDs.erase(it);
+            } else {
+                it->second = newTerm[it->second];
+                ++it;
+            }
+        }
+
+        vector<uint32_t> newSlot(docs.size(), UINT32_MAX);
+        uint32_t live = 0;
+        for (uint32_t slot = 0; slot < docs.size(); ++slot) {
+            if (!docs[slot].questionID) continue;
+            newSlot[slot] = live;
+            if (live != slot) {
+                docs[live] = move(docs[slot]);
+                copy_n(&signatures[size_t(slot) * SIGNATURE_SIZE], SIGNATURE_SIZE,
+                       &signatures[size_t(live) * SIGNATURE_SIZE]);
+            }
+            for (uint32_t& term : docs[live].terms) term = newTerm[term];
+            docOf[docs[live].questionID] = live;
+            ++live;
+        }
+        docs.resize(live);
+        signatures.resize(size_t(live) * SIGNATURE_SIZE);
+        for (vector<uint32_t>& list : postings)
+            for (uint32_t& slot : list) slot = newSlot[slot];
+        deadSlots = 0;
+    }
+
+    // Independent hash function number `seed` over 64-bit values (murmur3 finalizer)
+    static uint64_t mixHash(uint64_t value, uint64_t seed) {
+        uint64_t h = value * 0x9E3779B97F4A7C15ull ^ (seed + 1) * 0xD1B54A32D192ED03ull;
+        h = (h ^ (h >> 33)) * 0xFF51AFD7ED558CCDull;
+        h = (h ^ (h >> 33)) * 0xC4CEB9FE1A85EC53ull;
+        return h ^ (h >> 33);
+    }
+
+    static double jaccard(const vector<uint32_t>& a, const vector<uint32_t>& b) {
+        size_t common = 0;
+        for (size_t i = 0, j = 0; i < a.size() && j < b.size();) {
+            if (a[i] == b[j]) {
+                ++common;
+                ++i;
+                ++j;
+            } else if (a[i] < b[j]) {
+                ++i;
+            } else {
+                ++j;
+            }
+        }
+        return static_cast<double>(common) / (a.size() + b.size() - common);
+    }
+};
+
+// Bulk import outcome, shared with the user importer (bulk_import.h)
+using QuestionImportReport = ImportReport;
+
+// Half-open [start, end) intervals in an augmented treap keyed by (start, id).
+// Every node also keeps the largest end in its subtree, so an overlap query
+// skips any subtree that finishes before the query starts: expected O(log n)
+// per insert/erase and O(log n + k) to report k overlaps. Nodes live in one
+// vector and link by index.
+class IntervalTree {
+public:
+    struct Interval {
+        int64_t start, end;
+        int id;
+    };
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    void clear() {
+        nodes.clear();
+        freeSlots.clear();
+        root = NIL;
+        count = 0;
+    }
+
+    void insert(const Interval& interval) {
+        int32_t n;
+        if (!freeSlots.empty()) {
+            n = freeSlots.back();
+            freeSlots.pop_back();
+        } else {
+            n = static_cast<int32_t>(nodes.size());
+            nodes.emplace_back();
+        }
+        uint64_t h = uint64_t(interval.start) * 0x9E3779B97F4A7C15ull ^ uint32_t(interval.id);
+        nodes[n] = {interval, interval.end, uint32_t((h ^ (h >> 29)) * 0xBF58476D1CE4E5B9ull >> 32), NIL, NIL};
+        root = insertAt(root, n);
+        ++count;
+    }
+
+    // Removes the interval with this start and id; false if there is none
+    bool erase(int64_t start, int id) {
+        bool found = false;
+        root = eraseAt(root, start, id, found);
+        if (found) --count;
+        return found;
+    }
+
+    bool overlaps(int64_t start, int64_t end) const {
+        bool any = false;
+        auto stop = [&any](const Interval&) { any = true; return false; };
+        visit(root, start, end, stop);
+        return any;
+    }
+
+    // As above, disregarding intervals with this id (an exam's own booking)
+    bool overlaps(int64_t start, int64_t end, int ignoreID) const {
+        bool any = false;
+        auto stop = [&any, ignoreID](const Interval& interval) { any = interval.id != ignoreID; return !any; };
+        visit(root, start, end, stop);
+        return any;
+    }
+
+    // Calls f(interval) for every overlap, in start order, until f returns false
+    template <typename F>
+    void forEachOverlap(int64_t start, int64_t end, F&& f) const { visit(root, start, end, f); }
+
+    template <typename F>
+    void forEach(F&& f) const {
+        auto all = [&f](const Interval& interval) { f(interval); return true; };
+        visit(root, INT64_MIN, INT64_MAX, all);
+    }
+
+private:
+    static constexpr int32_t NIL = -1;
+    struct Node {
+        Interval interval;
+        int64_t maxEnd;
+        uint32_t priority;
+        int32_t left, right;
+    };
+    vector<Node> nodes;
+    vector<int32_t> freeSlots;
+    int32_t root = NIL;
+    size_t count = 0;
+
+    static bool before(const Interval& a, int64_t start, int id) {
+        return a.start < start || (a.start == start && a.id < id);
+    }
+    void update(int32_t n) {
+        Node& node = nodes[n];
+        node.maxEnd = node.interval.end;
+        if (node.left != NIL) node.maxEnd = max(node.maxEnd, nodes[node.left].maxEnd);
+        if (node.right != NIL) node.maxEnd = max(node.maxEnd, nodes[node.right].maxEnd);
+    }
+    int32_t rotateRight(int32_t n) {
+        int32_t l = nodes[n].left;
+        nodes[n].left = nodes[l].right;
+        nodes[l].right = n;
+        update(n);
+        update(l);
+        return l;
+    }
+    int32_t rotateLeft(int32_t n) {
+        int32_t r = nodes[n].right;
+        nodes[n].right = nodes[r].left;
+        nodes[r].left = n;
+        update(n);
+        update(r);
+        return r;
+    }
+    int32_t insertAt(int32_t t, int32_t n) {
+        if (t == NIL) return n;
+        if (before(nodes[n].interval, nodes[t].interval.start, nodes[t].interval.id)) {
+            nodes[t].left = insertAt(nodes[t].left, n);
+            if (nodes[nodes[t].left].priority > nodes[t].priority) return rotateRight(t);
+        } else {
+            nodes[t].right = insertAt(nodes[t].right, n);
+            if (nodes[nodes[t].right].priority > nodes[t].priority) return rotateLeft(t);
+        }
+        update(t);
+        return t;
+    }
+    int32_t merge(int32_t a, int32_t b) {
+        if (a == NIL) return b;
+        if (b == NIL) return a;
+        if (nodes[a].priority > nodes[b].priority) {
+            nodes[a].right = merge(nodes[a].right, b);
+            update(a);
+            return a;
+        }
+        nodes[b].left = merge(a, nodes[b].left);
+        update(b);
+        return b;
+    }
+    int32_t eraseAt(int32_t t, int64_t start, int id, bool& found) {
+        if (t == NIL) return NIL;
+        const Interval& here = nodes[t].interval;
+        if (here.start == start && here.id == id) {
+            found = true;
+            freeSlots.push_back(t);
+            return merge(nodes[t].left, nodes[t].right);
+        }
+        if (before(here, start, id)) nodes[t].right = eraseAt(nodes[t].right, start, id, found);
+        else nodes[t].left = eraseAt(nodes[t].left, start, id, found);
+        update(t);
+        return t;
+    }
+    // Returns false once f asked to stop
+    template <typename F>
+    bool visit(int32_t t, int64_t start, int64_t end, F& f) const {
+        if (t == NIL || nodes[t].maxEnd <= start) return true;
+        const Node& node = nodes[t];
+        if (!visit(node.left, start, end, f)) return false;
+        if (node.interval.start >= end) return true;   // the right subtree starts later still
+        if (node.interval.end > start && !f(node.interval)) return false;
+        return visit(node.right, start, end, f);
+    }
+};
+
+// Clock times are minutes since 1970-01-01 00:00, with no time zone attached
+namespace ScheduleTime {
+    // "YYYY-MM-DD HH:MM" (or just the date, at 00:00); false if malformed
+    inline bool parse(const string& text, int64_t& minutes) {
+        int y, mo, d, h = 0, mi = 0;
+        char tail;
+        int fields = sscanf(text.c_str(), "%d-%d-%d %d:%d %c", &y, &mo, &d, &h, &mi, &tail);
+        if ((fields != 3 && fields != 5) || mo < 1 || mo > 12 || h < 0 || h > 23 || mi < 0 || mi > 59)
+            return false;
+        static const int monthDays[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+        bool leap = (y % 4 == 0 && y % 100 != 0) || y % 400 == 0;
+        if (d < 1 || d > monthDays[mo - 1] + (mo == 2 && leap)) return false;
+        // days_from_civil (proleptic Gregorian)
+        int64_t yy = y - (mo <= 2);
+        int64_t era = (yy >= 0 ? yy : yy - 399) / 400;
+        int64_t yoe = yy - era * 400;
+        int64_t doy = (153 * (mo + (mo > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+        int64_t days = era * 146097 + yoe * 365 + yoe / 4 - yoe / 100 + doy - 719468;
+        minutes = days * 1440 + h * 60 + mi;
+        return true;
+    }
+
+    inline string format(int64_t minutes) {
+        int64_t days = minutes >= 0 ? minutes / 1440 : (minutes - 1439) / 1440;
+        int64_t rest = minutes - days * 1440;
+        // civil_from_days
+        int64_t z = days + 719468;
+        int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+        int64_t doe = z - era * 146097;
+        int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+        int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+        int64_t mp = (5 * doy + 2) / 153;
+        int64_t d = doy - (153 * mp + 2) / 5 + 1;
+        int64_t m = mp + (mp < 10 ? 3 : -9);
+        int64_t y = yoe + era * 400 + (m <= 2);
+        char buffer[5 * 24];   // room for five full-width %lld fields
+        snprintf(buffer, sizeof(buffer), "%04lld-%02lld-%02lld %02lld:%02lld", (long long)y, (long long)m,
+                 (long long)d, (long long)(rest / 60), (long long)(rest % 60));
+        return buffer;
+    }
+}
+
+// Why an exam cannot take a slot
+struct ScheduleConflict {
+    enum Kind { STUDENT, ROOM, CAPACITY, UNKNOWN_ROOM };
+    Kind kind;
+    int examID;
+    int otherExamID = 0;   // STUDENT and ROOM: the exam already there
+    int studentID = 0;     // STUDENT
+    string room;
+
+    string describe() const {
+        switch (kind) {
+        case STUDENT:
+            return "student " + to_string(studentID) + " already sits exam " + to_string(otherExamID) + " then";
+        case ROOM:
+            return "room " + room + " is booked for exam " + to_string(otherExamID);
+        case CAPACITY:
+            return "room " + room + " is too small for the cohort";
+        default:
+            return "no room named " + room;
+        }
+    }
+};
+
+// Exam timetable: each scheduled exam has a time window, a room and a cohort
+// of students. One interval tree per student and one per room hold the
+// windows booked so far, so a clash check is a tree query per cohort member
+// plus one for the room, however many exams are already placed.
+class ExamScheduler {
+public:
+    struct Slot {
+        int examID;
+        int64_t start, end;   // ScheduleTime minutes, [start, end)
+        string room;
+        vector<int> cohort;   // sorted student ids
+    };
+    struct WeekRequest {
+        int examID;
+        int duration;         // minutes
+        vector<int> cohort;
+    };
+    struct WeekReport {
+        size_t scheduled = 0;
+        vector<int> unscheduled;   // no period had a free room and a clash-free cohort
+        size_t probes = 0;         // interval tree queries made
+    };
+
+    void addRoom(const string& name, int capacity) {
+        if (name.empty() || capacity <= 0) throw ExamException("A room needs a name and a positive capacity");
+        rooms[name].capacity = capacity;
+        dirty = true;
+    }
+    bool hasRoom(const string& name) const { return rooms.count(name) > 0; }
+    int getRoomCapacity(const string& name) const {
+        auto it = rooms.find(name);
+        return it != rooms.end() ? it->second.capacity : 0;
+    }
+    template <typename F>
+    void forEachRoom(F&& f) const {
+        for (const auto& [name, room] : rooms) f(name, room.capacity);
+    }
+
+    // Appends up to limit reasons examID cannot have [start, end) in room;
+    // its own current booking is ignored. Returns the number appended
+    size_t findConflicts(int examID, int64_t start, int64_t end, const string& room,
+                         const vector<int>& cohort, vector<ScheduleConflict>& out, size_t limit = 20) const {
+        size_t before = out.size();
+        auto it = rooms.find(room);
+        if (it == rooms.end()) {
+            out.push_back({ScheduleConflict::UNKNOWN_ROOM, examID, 0, 0, room});
+            return 1;
+        }
+        if (cohort.size() > static_cast<size_t>(it->second.capacity))
+            out.push_back({ScheduleConflict::CAPACITY, examID, 0, 0, room});
+        it->second.bookings.forEachOverlap(start, end, [&](const IntervalTree::Interval& booked) {
+            if (booked.id != examID) out.push_back({ScheduleConflict::ROOM, examID, booked.id, 0, room});
+            return out.size() - before < limit;
+        });
+        for (int studentID : cohort) {
+            if (out.size() - before >= limit) break;
+            auto tree = studentTrees.find(studentID);
+            if (tree == studentTrees.end()) continue;
+            tree->second.forEachOverlap(start, end, [&](const IntervalTree::Interval& booked) {
+                if (booked.id != examID) out.push_back({ScheduleConflict::STUDENT, examID, booked.id, studentID, ""});
+                return out.size() - before < limit;
+            });
+        }
+        return out.size() - before;
+    }
+
+    // Books the slot when nothing clashes (moving the exam if it was already
+    // scheduled); otherwise fills conflicts and leaves the timetable unchanged
+    bool schedule(int examID, int64_t start, int64_t end, const string& room, vector<int> cohort,
+                  vector<ScheduleConflict>& conflicts) {
+        if (end <= start) throw ExamException("An exam window must end after it starts");
+        sort(cohort.begin(), cohort.end());
+        cohort.erase(unique(cohort.begin(), cohort.end()), cohort.end());
+        if (findConflicts(examID, start, end, room, cohort, conflicts) > 0) return false;
+        unschedule(examID);
+        book({examID, start, end, room, move(cohort)});
+        return true;
+    }
+
+    bool unschedule(int examID) {
+        auto it = slots.find(examID);
+        if (it == slots.end()) return false;
+        const Slot& slot = it->second;
+        auto room = rooms.find(slot.room);
+        if (room != rooms.end()) room->second.bookings.erase(slot.start, examID);
+        for (int studentID : slot.cohort) {
+            auto tree = studentTrees.find(studentID);
+            if (tree == studentTrees.end()) continue;
+            tree->second.erase(slot.start, examID);
+            if (tree->second.empty()) studentTrees.erase(tree);
+        }
+        slots.erase(it);
+        dirty = true;
+        return true;
+    }
+
+    const Slot* getSlot(int examID) const {
+        auto it = slots.find(examID);
+        return it != slots.end() ? &it->second : nullptr;
+    }
+    size_t size() const { return slots.size(); }
+
+    // The student's exams in time order
+    vector<const Slot*> timetableFor(int studentID) const {
+        vector<const Slot*> result;
+        auto tree = studentTrees.find(studentID);
+        if (tree != studentTrees.end())
+            tree->second.forEach([&](const IntervalTree::Interval& booked) { result.push_back(getSlot(booked.id)); });
+        return result;
+    }
+
+    // Every scheduled exam in time order
+    vector<const Slot*> timetable() const {
+        vector<const Slot*> result;
+        for (const auto& [examID, slot] : slots) result.push_back(&slot);
+        sort(result.begin(), result.end(), [](const Slot* a, const Slot* b) {
+            return a->start != b->start ? a->start < b->start : a->examID < b->examID;
+        });
+        return result;
+    }
+
+    // Bulk pass over an exam week: largest cohorts first, each exam takes the
+    // earliest period with a room that fits it and no cohort member already
+    // sitting something then. Exams scheduled before stay where they are: a
+    // requested exam keeps its slot until it is re-booked, and keeps it
+    // when no period fits
+    WeekReport scheduleWeek(vector<WeekRequest> requests, const vector<int64_t>& periodStarts) {
+        WeekReport report;
+        vector<pair<int, int>> roomsBySize;   // capacity, then name order, smallest first
+        vector<const string*> roomNames;
+        for (const auto& [name, room] : rooms) {
+            roomsBySize.push_back({room.capacity, static_cast<int>(roomNames.size())});
+            roomNames.push_back(&name);
+        }
+        sort(roomsBySize.begin(), roomsBySize.end());
+        for (auto& request : requests) {
+            sort(request.cohort.begin(), request.cohort.end());
+            request.cohort.erase(unique(request.cohort.begin(), request.cohort.end()), request.cohort.end());
+        }
+        stable_sort(requests.begin(), requests.end(), [](const WeekRequest& a, const WeekRequest& b) {
+            return a.cohort.size() > b.cohort.size();
+        });
+
+        for (auto& request : requests) {
+            if (request.duration <= 0) {
+                report.unscheduled.push_back(request.examID);
+                continue;
+            }
+            bool placed = false;
+            for (int64_t start : periodStarts) {
+                int64_t end = start + request.duration;
+                const string* room = nullptr;
+                for (const auto& [capacity, index] : roomsBySize) {
+                    if (static_cast<size_t>(capacity) < request.cohort.size()) continue;
+                    ++report.probes;
+                    if (!rooms[*roomNames[index]].bookings.overlaps(start, end, request.examID)) {
+                        room = roomNames[index];
+                        break;
+                    }
+                }
+                if (!room) continue;
+                bool clash = false;
+                for (int studentID : request.cohort) {
+                    auto tree = studentTrees.find(studentID);
+                    if (tree == studentTrees.end()) continue;
+                    ++report.probes;
+                    if (tree->second.overlaps(start, end, request.examID)) {
+                        clash = true;
+                        break;
+                    }
+                }
+                if (clash) continue;
+                unschedule(request.examID);
+                book({request.examID, start, end, *room, move(request.cohort)});
+                placed = true;
+                break;
+            }
+            if (placed) ++report.scheduled;
+            else report.unscheduled.push_back(request.examID);
+        }
+        return report;
+    }
+
+    json toJson() const {
+        json jRooms = json::object();
+        for (const auto& [name, room] : rooms) jRooms[name] = room.capacity;
+        json jSlots = json::array();
+        for (const auto& [examID, slot] : slots) {
+            jSlots.push_back({{"examID", examID}, {"start", ScheduleTime::format(slot.start)},
+                              {"minutes", slot.end - slot.start}, {"room", slot.room}, {"cohort", slot.cohort}});
+        }
+        return {{"rooms", jRooms}, {"slots", jSlots}};
+    }
+
+    void loadFromJson(const json& j) {
+        rooms.clear();
+        slots.clear();
+        studentTrees.clear();
+        json jRooms = j.value("rooms", json::object());
+        json jSlots = j.value("slots", json::array());
+        for (auto& [name, capacity] : jRooms.items()) rooms[name].capacity = capacity.get<int>();
+        for (const auto& jSlot : jSlots) {
+            int64_t start;
+            if (!ScheduleTime::parse(jSlot["start"].get<string>(), start)) continue;
+            if (!hasRoom(jSlot["room"].get<string>())) {
+                cout << "Skipping exam " << jSlot["examID"] << " in the timetable: room "
+                     << jSlot["room"].get<string>() << " does not exist" << endl;
+                continue;
+            }
+            book({jSlot["examID"].get<int>(), start, start + jSlot["minutes"].get<int64_t>(),
+                  jSlot["room"].get<string>(), jSlot["cohort"].get<vector<int>>()});
+        }
+        dirty = false;
+    }
+
+    bool isDirty() const { return dirty; }
+    void markClean() { dirty = false; }
+
+private:
+    struct Room {
+        int capacity = 0;
+        IntervalTree bookings;
+    };
+    map<string, Room> rooms;
+    map<int, Slot> slots;
+    unordered_map<int, IntervalTree> studentTrees;
+    bool dirty = false;
+
+    // Rooms are only created by addRoom; a booking never invents one
+    void book(Slot slot) {
+        auto room = rooms.find(slot.room);
+        if (room == rooms.end()) throw ExamException("Room " + slot.room + " does not exist");
+        room->second.bookings.insert({slot.start, slot.end, slot.examID});
+        for (int studentID : slot.cohort) studentTrees[studentID].insert({slot.start, slot.end, slot.examID});
+        slots[slot.examID] = move(slot);
+        dirty = true;
+    }
+};
+
+// Exams are stored one shard per exam (exams/exam_<id>.json) and loaded on
+// demand into an LRU cache; exams/meta.json holds the id counters. Nothing
+// at startup or menu entry reads more than meta.json. A legacy exams.json is
+// split into shards the first time the store is opened.
+// Writes are incremental: only exams edited since their last write (and the
+// counters, if they moved) are saved, however many edits came in between.
+// Callers save when a burst ends; every AUTOSAVE_EDITS edits are saved anyway,
+// so a crash mid-burst loses at most that many.
+// Sessions read a compiled image (exams/exam_<id>.pack) of the saved shard,
+// mapped once and shared. Every edit gives the exam a new version id; a session
+// pins the version it started on and, when the shard is written again, a
+// pinned pack is kept as exams/exam_<id>_v<version>.pack instead of being
+// dropped. The last release deletes it. Pin counts are saved in meta.json;
+// each pin and release in between is one line appended to exams/pins.log,
+// folded into meta.json (and the log emptied) on the next save.
+// The exam timetable (rooms, windows, cohorts) lives in exams/schedule.json,
+// read on first use.
+class ExamManager {
+private:
+    static inline ExamManager* instance = nullptr;  // Fixed: inline static member
+    static inline const filesystem::path storeDir = "exams";
+    static inline const filesystem::path legacyFile = "exams.json";
+    static const size_t DEFAULT_CACHE_CAPACITY = 64;
+    static const size_t AUTOSAVE_EDITS = 16;
+
+    // Dirty exams are written back on eviction so no edit is lost.
+    // The store is opened lazily, from const readers too
+    mutable LRUCache<int, Exam> cache{DEFAULT_CACHE_CAPACITY};
+    mutable int currentExamID = 1000;
+    mutable int currentQuestionID = 1;
+    mutable bool storeOpened = false;
+    mutable bool metaDirty = false;
+    mutable size_t shardWrites = 0;
+    mutable size_t editsSinceSave = 0;  // reset by every save
+    mutable map<int, shared_ptr<const ExamImage>> images;   // valid while the shard is unchanged
+    mutable map<int, map<int, int>> pins;                   // examID -> version -> pinning sessions
+    mutable ofstream pinLog;                                // appended to on every pin and release
+    mutable size_t pinLogRecords = 0;                       // changes not yet folded into meta.json
+    mutable map<pair<int, int>, weak_ptr<const ExamImage>> retiredImages;  // older versions still mapped
+
+    // Built on the first search from every stored exam, then kept up to date
+    // by each add/modify/remove/import/delete below
+    mutable QuestionIndex questionIndex;
+    mutable bool indexBuilt = false;
+
+    mutable ExamScheduler scheduler;
+    mutable bool scheduleLoaded = false;
+
+    ExamManager() = default;
+    ExamManager(const ExamManager&) = delete;
+    ExamManager& operator=(const ExamManager&) = delete;
+
+    static filesystem::path shardPath(int examID) {
+        return storeDir / ("exam_" + to_string(examID) + ".json");
+    }
+
+    static filesystem::path packPath(int examID) {
+        return storeDir / ("exam_" + to_string(examID) + ".pack");
+    }
+
+    // A pack is usable when it is at least as new as the shard it came from
+    static bool packIsCurrent(int examID) {
+        error_code ec;
+        auto packTime = filesystem::last_write_time(packPath(examID), ec);
+        if (ec) return false;
+        auto shardTime = filesystem::last_write_time(shardPath(examID), ec);
+        return !ec && packTime >= shardTime;
+    }
+
+    static filesystem::path retiredPackPath(int examID, int version) {
+        return storeDir / ("exam_" + to_string(examID) + "_v" + to_string(version) + ".pack");
+    }
+
+    bool isPinned(int examID, int version) const {
+        auto exam = pins.find(examID);
+        return exam != pins.end() && exam->second.count(version);
+    }
+
+    // The shard is about to change: the current pack is kept under its version
+    // while sessions pin it, otherwise deleted
+    void dropImage(int examID) const {
+        shared_ptr<const ExamImage> mapped;
+        auto it = images.find(examID);
+        if (it != images.end()) {
+            mapped = move(it->second);
+            images.erase(it);
+        }
+        int version = mapped ? mapped->getVersion() : ExamImage::readVersion(packPath(examID));
+        error_code ec;
+        if (version >= 0 && isPinned(examID, version)) {
+            filesystem::rename(packPath(examID), retiredPackPath(examID, version), ec);
+            if (mapped) retiredImages[{examID, version}] = mapped;
+        } else {
+            filesystem::remove(packPath(examID), ec);
+        }
+    }
+
+    static void writeFileAtomically(const filesystem::path& path, const string& contents) {
+        filesystem::path tmpPath = path;
+        tmpPath += ".tmp";
+        {
+            ofstream out(tmpPath, ios::binary | ios::trunc);
+            if (!out)
+                throw ExamException("Unable to open " + tmpPath.string() + " for writing");
+            out << contents;
+        }
+        filesystem::rename(tmpPath, path);
+    }
+
+    static void writeShard(const Exam& exam) {
+        // Compact: shards are rewritten on every flush and only ever read back by the loader
+        writeFileAtomically(shardPath(exam.getExamID()), exam.toJson().dump());
+    }
+
+    void flushExam(Exam& exam) const {
+        if (!exam.isDirty()) return;
+        writeShard(exam);
+        exam.markClean();
+        ++shardWrites;
+        dropImage(exam.getExamID());  // sessions already holding it keep their mapping
+    }
+
+    void writeMeta() const {
+        json meta = {{"nextExamID", currentExamID}, {"nextQuestionID", currentQuestionID}};
+        json jPins = json::object();
+        for (const auto& [examID, versions] : pins)
+            for (const auto& [version, count] : versions)
+                jPins[to_string(examID)][to_string(version)] = count;
+        meta["pins"] = jPins;
+        writeFileAtomically(storeDir / "meta.json", meta.dump(4));
+        metaDirty = false;
+
+        // meta.json now holds every logged change. A crash before the log is
+        // emptied replays it on top again: pins are over-counted (packs kept
+        // too long), never lost
+        if (pinLogRecords) {
+            pinLog.close();
+            ofstream(storeDir / "pins.log", ios::binary | ios::trunc);
+            pinLogRecords = 0;
+        }
+    }
+
+    // One line per change: {"exam":N,"version":N,"delta":1 or -1}
+    void appendPinRecord(int examID, int version, int delta) const {
+        if (!pinLog.is_open()) {
+            pinLog.open(storeDir / "pins.log", ios::binary | ios::app);
+            if (!pinLog) throw ExamException("Unable to open " + (storeDir / "pins.log").string());
+        }
+        pinLog << json{{"exam", examID}, {"version", version}, {"delta", delta}}.dump() << '\n';
+        pinLog.flush();
+        ++pinLogRecords;
+    }
+
+    void applyPinDelta(int examID, int version, int delta) const {
+        auto exam = pins.find(examID);
+        if (exam == pins.end()) {
+            if (delta <= 0) return;
+            exam = pins.emplace(examID, map<int, int>()).first;
+        }
+        int& count = exam->second[version];
+        count += delta;
+        if (count <= 0) {
+            exam->second.erase(version);
+            if (exam->second.empty()) pins.erase(exam);
+        }
+    }
+
+    // Changes logged since meta.json was last written; a torn last line is skipped
+    void replayPinLog() const {
+        ifstream in(storeDir / "pins.log", ios::binary);
+        string line;
+        while (getline(in, line)) {
+            if (in.eof()) break;  // no trailing newline: the write never finished
+            if (line.empty()) continue;
+            try {
+                json record = json::parse(line);
+                applyPinDelta(record.at("exam").get<int>(), record.at("version").get<int>(),
+                              record.at("delta").get<int>());
+                ++pinLogRecords;
+            } catch (const json::exception&) {
+                // Skip a corrupt record rather than losing the rest of the log
+            }
+        }
+    }
+
+    ExamScheduler& loadSchedule() const {
+        openStore();
+        if (!scheduleLoaded) {
+            ifstream in(storeDir / "schedule.json");
+            if (in) {
+                json j;
+                in >> j;
+                scheduler.loadFromJson(j);
+            }
+            scheduleLoaded = true;
+        }
+        return scheduler;
+    }
+
+    void writeSchedule() const {
+        writeFileAtomically(storeDir / "schedule.json", scheduler.toJson().dump(4));
+        scheduler.markClean();
+    }
+
+    int nextQuestionID() {
+        metaDirty = true;
+        return currentQuestionID++;
+    }
+
+    // Called once per completed edit, after the last use of any Exam& it took
+    void editMade() {
+        if (++editsSinceSave >= AUTOSAVE_EDITS) saveExamsToFile();
+    }
+
+    static bool readShard(int examID, Exam& exam) {
+        ifstream in(shardPath(examID));
+        if (!in) return false;
+        json j;
+        in >> j;
+        exam.loadFromJson(j);
+        exam.markClean();
+        return true;
+    }
 
+    // Ids of every stored exam, ascending (a directory listing, used by displayAllExams)
+    static vector<int> storedExamIDs() {
+        vector<int> ids;
+        error_code ec;
+        for (const auto& entry : filesystem::directory_iterator(storeDir, ec)) {
+            string name = entry.path().filename().string();
+            if (name.rfind("exam_", 0) == 0 && entry.path().extension() == ".json")
+                ids.push_back(atoi(name.c_str() + 5));
+        }
+        sort(ids.begin(), ids.end());
+        return ids;
+    }
+
+    // One-time split of the old single-file store
+    void migrateLegacyFile() const {
+        ifstream inFile(legacyFile);
+        if (!inFile) return;
         json j;
         inFile >> j;
         inFile.close();
 
-        container = ExamContainer<Exam>(); // Clear existing exams
         for (auto& examData : j) {
             Exam exam;
             exam.loadFromJson(examData);
-            container.addExam(move(exam));
+            currentExamID = max(currentExamID, exam.getExamID() + 1);
+            for (const auto& q : *exam.getQuestions())
+                currentQuestionID = max(currentQuestionID, q->getQuestionID() + 1);
+            writeShard(exam);
+        }
+    }
+
+    void openStore() const {
+        if (storeOpened) return;
+        if (!filesystem::exists(storeDir)) {
+            filesystem::create_directories(storeDir);
+            migrateLegacyFile();
+            writeMeta();
+        }
+        ifstream metaFile(storeDir / "meta.json");
+        if (metaFile) {
+            json meta;
+            metaFile >> meta;
+            currentExamID = max(currentExamID, meta.value("nextExamID", currentExamID));
+            currentQuestionID = max(currentQuestionID, meta.value("nextQuestionID", currentQuestionID));
+            json jPins = meta.value("pins", json::object());
+            for (auto& [examID, versions] : jPins.items())
+                for (auto& [version, count] : versions.items())
+                    pins[stoi(examID)][stoi(version)] = count.get<int>();
+        }
+        replayPinLog();
+        storeOpened = true;
+    }
+
+    Exam& cacheExam(Exam&& exam) const {
+        int examID = exam.getExamID();
+        return cache.put(examID, move(exam), [this](int, Exam& evicted) { flushExam(evicted); });
+    }
+
+    // Cache first, then the exam's shard; nullptr when it does not exist
+    Exam* findExam(int examID) const {
+        openStore();
+        if (Exam* cached = cache.get(examID)) return cached;
+        Exam loaded;
+        if (!readShard(examID, loaded)) return nullptr;
+        return &cacheExam(move(loaded));
+    }
+
+    Exam& requireExam(int examID) const {
+        Exam* exam = findExam(examID);
+        if (!exam)
+            throw ExamException("Exam ID " + to_string(examID) + " not found");
+        return *exam;
+    }
+
+    void indexQuestion(const Exam& exam, int questionID) const {
+        if (!indexBuilt) return;
+        if (shared_ptr<const Question> question = exam.getQuestion(questionID))
+            questionIndex.add(exam.getExamID(), *question);
+    }
+
+    // One pass over the store: cached exams from memory, the rest from their
+    // shards without disturbing the cache
+    const QuestionIndex& ensureIndex() const {
+        if (indexBuilt) return questionIndex;
+        openStore();
+        auto addExam = [this](const Exam& exam) {
+            for (const auto& question : *exam.getQuestions()) questionIndex.add(exam.getExamID(), *question);
+        };
+        set<int> seen;
+        for (int examID : storedExamIDs()) {
+            if (const Exam* cached = cache.peek(examID)) {
+                addExam(*cached);
+            } else {
+                Exam exam;
+                if (readShard(examID, exam)) addExam(exam);
+            }
+            seen.insert(examID);
+        }
+        cache.forEach([&](int examID, const Exam& exam) {
+            if (!seen.count(examID)) addExam(exam);  // created, not yet saved
+        });
+        indexBuilt = true;
+        return questionIndex;
+    }
+
+    // Validates one parsed row and builds its question; empty reason on success.
+    // Numeric tolerances come from the record (JSON) or the fields after the answer (CSV)
+    static unique_ptr<Question> makeImportedQuestion(int questionID, const string& type, string text,
+                                                     const json& answer, vector<string> options, string& reason,
+                                                     double absTolerance = 0, double relTolerance = 0) {
+        if (text.empty()) {
+            reason = "question text is required";
+            return nullptr;
+        }
+        if (type == "Descriptive") {
+            if (!answer.is_string() || answer.get<string>().empty()) {
+                reason = "a Descriptive question needs an answer";
+                return nullptr;
+            }
+            return make_unique<Descriptive>(questionID, move(text), answer.get<string>());
+        }
+        if (type == "TrueFalse") {
+            int choice = answer.is_boolean() ? (answer.get<bool>() ? 0 : 1)
+                       : answer.is_string() ? TrueFalse::parseChoice(answer.get<string>()) : -1;
+            if (choice < 0) {
+                reason = "a TrueFalse answer must be true or false, got " + answer.dump();
+                return nullptr;
+            }
+            return make_unique<TrueFalse>(questionID, move(text), choice == 0);
+        }
+        if (type == "MultiSelect") {
+            if (options.size() < 2 || options.size() > MultiSelect::MAX_OPTIONS) {
+                reason = "a MultiSelect question needs between 2 and " + to_string(MultiSelect::MAX_OPTIONS) + " options";
+                return nullptr;
+            }
+            uint64_t mask = 0;
+            bool valid = answer.is_array() && !answer.empty();
+            if (valid) {
+                for (const auto& index : answer) {
+                    valid = index.is_number_integer() && index.get<int>() >= 0 && index.get<size_t>() < options.size();
+                    if (!valid) break;
+                    mask |= 1ull << index.get<int>();
+                }
+            } else if (answer.is_string()) {
+                valid = MultiSelect::parseSelection(answer.get<string>(), options.size(), mask);
+            }
+            if (!valid) {
+                reason = "answer " + answer.dump() + " does not name options of the question";
+                return nullptr;
+            }
+            return make_unique<MultiSelect>(questionID, move(text), mask, move(options));
+        }
+        if (type == "Numeric") {
+            double value;
+            bool valid = answer.is_number() ? (value = answer.get<double>(), true)
+                       : answer.is_string() && Numeric::parse(answer.get<string>(), value);
+            if (!valid) {
+                reason = "a Numeric answer must be a number, got " + answer.dump();
+                return nullptr;
+            }
+            for (size_t i = 0; i < options.size() && i < 2; ++i) {
+                double& tolerance = i == 0 ? absTolerance : relTolerance;
+                if (!options[i].empty() && !Numeric::parse(options[i], tolerance)) {
+                    reason = "tolerance '" + options[i] + "' is not a number";
+                    return nullptr;
+                }
+            }
+            if (absTolerance < 0 || relTolerance < 0) {
+                reason = "tolerances cannot be negative";
+                return nullptr;
+            }
+            return make_unique<Numeric>(questionID, move(text), value, absTolerance, relTolerance);
+        }
+        if (type != "MCQ") {
+            reason = "unknown question type '" + type + "' (expected MCQ, Descriptive, TrueFalse, MultiSelect or Numeric)";
+            return nullptr;
+        }
+        if (options.size() < 2 || options.size() > MCQ::MAX_OPTIONS) {
+            reason = "an MCQ needs between 2 and " + to_string(MCQ::MAX_OPTIONS) + " options";
+            return nullptr;
+        }
+        int correct = answer.is_number_integer() ? answer.get<int>()
+                    : answer.is_string() ? MCQ::resolveChoice(options, answer.get<string>()) : -1;
+        if (correct < 0 || static_cast<size_t>(correct) >= options.size()) {
+            reason = "answer " + answer.dump() + " is not one of the options";
+            return nullptr;
+        }
+        return make_unique<MCQ>(questionID, move(text), correct, move(options));
+    }
+
+public:
+    enum class ImportFormat { CSV, JSONLines };
+
+    static ExamManager* getInstance() {
+        if (!instance)
+            instance = new ExamManager();
+        return instance;
+    }
+
+    int getCurrentExamID() const {
+        return currentExamID;
+    }
+
+    // CONCEPT: Function Overloading
+    int createExam(string subject, int duration) {
+        openStore();
+        int examID = currentExamID++;
+        metaDirty = true;
+        Exam exam(examID, subject, duration);
+        exam.markDirty();
+        cacheExam(move(exam));
+        editMade();
+        return examID;
+    }
+    
+    int createExam(int teacherID, string subject, int duration) {
+        return createExam(subject, duration);
+    }
+
+    // For MCQ, `answer` is the correct option's letter or text, resolved once the options are read
+    int addQuestion(int examID, string questionText, string type, string answer) {
+        Exam& exam = requireExam(examID);
+        if (type == "MCQ") {
+            vector<string> options;
+            string opt;
+            cin.ignore();
+            cout << "Enter 4 options:\n";
+            for (int i = 0; i < 4; ++i) {
+                cout << "Option " << char('A' + i) << ": ";
+                getline(cin, opt);
+                options.push_back(opt);
+            }
+            return addMCQuestion(examID, questionText, answer, options);
         }
+        if (type == "TrueFalse") {
+            int choice = TrueFalse::parseChoice(answer);
+            if (choice < 0) throw ExamException("A True/False answer must be true or false");
+            return addTrueFalseQuestion(examID, questionText, choice == 0);
+        }
+        if (type == "MultiSelect") {
+            vector<string> options;
+            string opt;
+            int count = 0;
+            cout << "Number of options: ";
+            cin >> count;
+            cin.ignore();
+            for (int i = 0; i < count; ++i) {
+                cout << "Option " << char('A' + i) << ": ";
+                getline(cin, opt);
+                options.push_back(opt);
+            }
+            uint64_t mask;
+            if (!MultiSelect::parseSelection(answer, options.size(), mask))
+                throw ExamException("Correct answer '" + answer + "' must be option letters, e.g. A,C");
+            return addMultiSelectQuestion(examID, questionText, mask, move(options));
+        }
+        if (type == "Numeric") {
+            double value, tolerance = 0;
+            if (!Numeric::parse(answer, value))
+                throw ExamException("Correct answer '" + answer + "' is not a number");
+            cout << "Tolerance (0 for an exact answer): ";
+            cin >> tolerance;
+            return addNumericQuestion(examID, questionText, value, tolerance);
+        }
+        int qID = nextQuestionID();
+        exam.addQuestion(make_unique<Descriptive>(qID, questionText, answer));
+        indexQuestion(exam, qID);
+        editMade();
+        return qID;
+    }
+
+    int addMCQuestion(int examID, string questionText, string answer, vector<string> options) {
+        int correct = MCQ::resolveChoice(options, answer);
+        if (correct < 0)
+            throw ExamException("Correct answer '" + answer + "' is not one of the options");
+        return addMCQuestion(examID, questionText, correct, move(options));
+    }
+
+    int addMCQuestion(int examID, string questionText, int correctOption, vector<string> options) {
+        Exam& exam = requireExam(examID);
+        if (options.size() > MCQ::MAX_OPTIONS)
+            throw ExamException("Too many options for an MCQ");
+        if (correctOption < 0 || static_cast<size_t>(correctOption) >= options.size())
+            throw ExamException("Correct option index out of range");
+        int qID = nextQuestionID();
+        exam.addQuestion(make_unique<MCQ>(qID, questionText, correctOption, move(options)));
+        indexQuestion(exam, qID);
+        editMade();
+        return qID;
+    }
+
+    int addTrueFalseQuestion(int examID, string questionText, bool answer) {
+        Exam& exam = requireExam(examID);
+        int qID = nextQuestionID();
+        exam.addQuestion(make_unique<TrueFalse>(qID, questionText, answer));
+        indexQuestion(exam, qID);
+        editMade();
+        return qID;
+    }
+
+    int addMultiSelectQuestion(int examID, string questionText, uint64_t correctMask, vector<string> options) {
+        Exam& exam = requireExam(examID);
+        if (options.size() > MultiSelect::MAX_OPTIONS)
+            throw ExamException("Too many options for a MultiSelect question");
+        if (!correctMask || (correctMask & ~MultiSelect::maskFor(options.size())))
+            throw ExamException("Correct options out of range");
+        int qID = nextQuestionID();
+        exam.addQuestion(make_unique<MultiSelect>(qID, questionText, correctMask, move(options)));
+        indexQuestion(exam, qID);
+        editMade();
+        return qID;
+    }
+
+    int addNumericQuestion(int examID, string questionText, double value,
+                           double absTolerance = 0, double relTolerance = 0) {
+        Exam& exam = requireExam(examID);
+        if (!isfinite(value) || absTolerance < 0 || relTolerance < 0)
+            throw ExamException("Invalid value or tolerance for a Numeric question");
+        int qID = nextQuestionID();
+        exam.addQuestion(make_unique<Numeric>(qID, questionText, value, absTolerance, relTolerance));
+        indexQuestion(exam, qID);
+        editMade();
+        return qID;
+    }
+
+    int addDescriptiveQuestion(int examID, string questionText, string answer) {
+        Exam& exam = requireExam(examID);
+        int qID = nextQuestionID();
+        exam.addQuestion(make_unique<Descriptive>(qID, questionText, answer));
+        indexQuestion(exam, qID);
+        editMade();
+        return qID;
+    }
+
+    // Bulk import into one exam, streamed line by line. Each row is one of
+    //   CSV:        type,question text,answer[,option,option,...]
+    //               (Numeric: type,question text,value[,absolute tolerance[,relative tolerance]])
+    //   JSON Lines: {"type","questionText","answer","options"} (the shard's own
+    //               question format, so exported questions import as they are)
+    // An MCQ answer is the option's index (JSON), letter or text; a MultiSelect
+    // answer is a list of indices (JSON) or letters ("AC"). Valid rows get
+    // one contiguous block of question ids, are published as a single new
+    // question set and persisted with one shard write.
+    QuestionImportReport importQuestions(int examID, istream& in, ImportFormat format) {
+        QuestionImportReport report;
+        Exam& exam = requireExam(examID);
+        vector<unique_ptr<Question>> batch;
+        int nextID = currentQuestionID;
+
+        string line;
+        vector<string> fields;
+        size_t lineNo = 0;
+        while (getline(in, line)) {
+            ++lineNo;
+            if (line.empty() || line == "\r") continue;
+
+            string type, text, reason;
+            json answer;
+            vector<string> options;
+            double absTolerance = 0, relTolerance = 0;
+            if (format == ImportFormat::CSV) {
+                if (!parseCSVLine(line, fields)) {
+                    report.errors.push_back({lineNo, "unterminated quoted field"});
+                    continue;
+                }
+                if (lineNo == 1 && fields[0] == "type") continue;  // header
+                if (fields.size() < 3) {
+                    report.errors.push_back({lineNo, "expected type,question,answer[,options...], got " +
+                                                     to_string(fields.size()) + " fields"});
+                    continue;
+                }
+                type = move(fields[0]);
+                text = move(fields[1]);
+                answer = move(fields[2]);
+                options.assign(make_move_iterator(fields.begin() + 3), make_move_iterator(fields.end()));
+            } else {
+                try {
+                    json j = json::parse(line);
+                    type = j.at("type").get<string>();
+                    text = j.at("questionText").get<string>();
+                    answer = j.at("answer");
+                    if (j.contains("options")) options = j["options"].get<vector<string>>();
+                    absTolerance = j.value("absTolerance", 0.0);
+                    relTolerance = j.value("relTolerance", 0.0);
+                } catch (const json::exception& e) {
+                    report.errors.push_back({lineNo, string("invalid JSON record: ") + e.what()});
+                    continue;
+                }
+            }
+
+            unique_ptr<Question> question = makeImportedQuestion(nextID, type, move(text), answer, move(options), reason,
+                                                                 absTolerance, relTolerance);
+            if (!question) {
+                report.errors.push_back({lineNo, reason});
+                continue;
+            }
+            batch.push_back(move(question));
+            ++nextID;
+        }
+        if (batch.empty()) return report;
+
+        report.firstID = currentQuestionID;
+        report.lastID = nextID - 1;
+        report.imported = batch.size();
+        currentQuestionID = nextID;
+        metaDirty = true;
+        exam.addQuestions(move(batch));
+        for (int qID = report.firstID; qID <= report.lastID; ++qID) indexQuestion(exam, qID);
+
+        // Single write for the whole batch
+        flushExam(exam);
+        writeMeta();
+        return report;
+    }
+
+    QuestionImportReport importQuestionsFromFile(int examID, const string& path) {
+        ifstream in(path, ios::binary);
+        if (!in.is_open()) {
+            QuestionImportReport report;
+            report.errors.push_back({0, "cannot open " + path});
+            return report;
+        }
+        string ext = filesystem::path(path).extension().string();
+        ImportFormat format = (ext == ".jsonl" || ext == ".ndjson") ? ImportFormat::JSONLines : ImportFormat::CSV;
+        return importQuestions(examID, in, format);
+    }
+
+    void removeQuestion(int examID, int questionID) {
+        Exam& exam = requireExam(examID);
+        exam.removeQuestion(questionID);
+        if (indexBuilt) questionIndex.remove(questionID);
+        editMade();
+    }
+
+    void modifyQuestion(int examID, int questionID, string newText) {
+        Exam& exam = requireExam(examID);
+        exam.modifyQuestion(questionID, newText);
+        indexQuestion(exam, questionID);
+        editMade();
+    }
+
+    // Sessions still holding one of its images keep their mapping
+    void deleteExam(int examID) {
+        openStore();
+        cache.erase(examID);
+        images.erase(examID);
+        if (indexBuilt) questionIndex.removeExam(examID);
+        error_code ec;
+        filesystem::remove(packPath(examID), ec);
+        auto pinned = pins.find(examID);
+        if (pinned != pins.end()) {
+            for (const auto& [version, count] : pinned->second) {
+                retiredImages.erase({examID, version});
+                filesystem::remove(retiredPackPath(examID, version), ec);
+            }
+            pins.erase(pinned);
+            writeMeta();
+        }
+        filesystem::remove(shardPath(examID), ec);
+        if (loadSchedule().unschedule(examID)) writeSchedule();
+    }
+
+    void displayExam(int examID) const {
+        const Exam& exam = requireExam(examID);
+        exam.displayExam();
+    }
+
+    // Walks the whole store; cached exams are shown from memory, the rest are
+    // read straight from their shards without disturbing the cache
+    void displayAllExams() const {
+        openStore();
+        set<int> shown;
+        for (int examID : storedExamIDs()) {
+            if (const Exam* cached = cache.peek(examID)) {
+                cout << *cached << endl;
+            } else {
+                Exam exam;
+                if (readShard(examID, exam)) cout << exam << endl;
+            }
+            shown.insert(examID);
+        }
+        cache.forEach([&](int examID, const Exam& exam) {
+            if (!shown.count(examID)) cout << exam << endl;  // created, not yet saved
+        });
+    }
+
+    // Shared, immutable question set: no per-session copies
+    QuestionSetPtr getExamQuestions(int examID) const {
+        const Exam& exam = requireExam(examID);
+        return exam.getQuestions();
+    }
+
+    // Compiled image of the exam as saved. While the shard is unchanged the
+    // mapped image (or an up-to-date pack on disk) is used without parsing the
+    // shard; otherwise it is rebuilt, writing unsaved edits to the shard first
+    shared_ptr<const ExamImage> getExamImage(int examID) const {
+        openStore();
+        const Exam* cached = cache.peek(examID);
+        if (!cached || !cached->isDirty()) {
+            auto it = images.find(examID);
+            if (it != images.end()) return it->second;
+            if (packIsCurrent(examID)) {
+                auto image = make_shared<ExamImage>();
+                if (image->open(packPath(examID))) return images[examID] = image;
+            }
+        }
+
+        Exam& exam = requireExam(examID);
+        flushExam(exam);
+        writeFileAtomically(packPath(examID), ExamImage::build(exam));
+        auto image = make_shared<ExamImage>();
+        if (!image->open(packPath(examID)))
+            throw ExamException("Unable to map " + packPath(examID).string());
+        return images[examID] = image;
+    }
+
+    // Exactly the given version of the exam: the current one, or an older
+    // version kept because sessions pin it. Throws once it has been reclaimed
+    shared_ptr<const ExamImage> getExamImage(int examID, int version) const {
+        openStore();
+        auto retired = retiredImages.find({examID, version});
+        if (retired != retiredImages.end()) {
+            if (auto image = retired->second.lock()) return image;
+            retiredImages.erase(retired);
+        }
+        auto image = make_shared<ExamImage>();
+        if (image->open(retiredPackPath(examID, version)) && image->getVersion() == version) {
+            retiredImages[{examID, version}] = image;
+            return image;
+        }
+        shared_ptr<const ExamImage> current = getExamImage(examID);
+        if (current->getVersion() != version)
+            throw ExamException("Version " + to_string(version) + " of exam " + to_string(examID) +
+                                " is no longer available");
+        return current;
+    }
+
+    // A session started on this version; it outlives later edits until released.
+    // Pins are dropped when the session is graded, fails grading once finished,
+    // or is discarded unfinished; deleteExam drops every pin of the exam
+    void pinVersion(int examID, int version) {
+        openStore();
+        appendPinRecord(examID, version, 1);  // logged at once: a lost pin would let the pack be reclaimed
+        ++pins[examID][version];
+    }
+
+    // The last release of a version other than the current one deletes its pack;
+    // sessions still holding the mapping keep reading it
+    void releaseVersion(int examID, int version) {
+        openStore();
+        auto exam = pins.find(examID);
+        if (exam == pins.end()) return;
+        auto pinned = exam->second.find(version);
+        if (pinned == exam->second.end()) return;
+        appendPinRecord(examID, version, -1);
+        if (--pinned->second <= 0) {
+            exam->second.erase(pinned);
+            if (exam->second.empty()) pins.erase(exam);
+            retiredImages.erase({examID, version});
+            error_code ec;
+            filesystem::remove(retiredPackPath(examID, version), ec);
+        }
+    }
+
+    int getPinCount(int examID, int version) const {
+        openStore();
+        auto exam = pins.find(examID);
+        if (exam == pins.end()) return 0;
+        auto pinned = exam->second.find(version);
+        return pinned != exam->second.end() ? pinned->second : 0;
+    }
+
+    // Questions across all exams containing every word of the query; returns
+    // the number of matches and appends up to limit of them to hits
+    size_t searchQuestions(const string& query, vector<QuestionIndex::Hit>& hits, size_t limit = 20) const {
+        return ensureIndex().search(query, hits, limit);
+    }
+
+    vector<QuestionIndex::DuplicatePair> findNearDuplicates(double threshold = 0.8, size_t limit = 50) const {
+        return ensureIndex().nearDuplicates(threshold, limit);
+    }
+
+    // Per-student variants: each student gets the questions (drawCount of
+    // them, or all when 0) and the MCQ options in their own order
+    void setRandomization(int examID, bool enabled, int drawCount = 0) {
+        Exam& exam = requireExam(examID);
+        if (drawCount < 0 || static_cast<size_t>(drawCount) > exam.getQuestions()->size())
+            throw ExamException("Draw count must be between 0 and the number of questions");
+        uint64_t salt = exam.getVariantSalt();
+        if (enabled && !salt) {
+            random_device rd;
+            salt = (uint64_t(rd()) << 32 | rd()) | 1;
+        }
+        exam.setRandomization(enabled, drawCount, salt);
+        editMade();
+    }
+
+    ExamVariant generateVariant(int examID, int studentID) const {
+        return ExamVariant::forStudent(*getExamImage(examID), studentID);
+    }
+
+    shared_ptr<const Question> getQuestion(int examID, int questionID) const {
+        const Exam& exam = requireExam(examID);
+        return exam.getQuestion(questionID);
+    }
+
+    map<int, bool> checkExamAnswers(int examID, const map<int, uint8_t>& choices, const map<int, string>& texts) const {
+        const Exam& exam = requireExam(examID);
+        return exam.checkAnswers(choices, texts);
+    }
+
+    // Loads the exam into the cache if needed; the pointer stays valid until
+    // the exam is evicted (after DEFAULT_CACHE_CAPACITY other exams are touched)
+    Exam* getExam(int examID) {
+        return findExam(examID);
+    }
+
+    int getExamDuration(int examID) const {
+        const Exam& exam = requireExam(examID);
+        return exam.getDuration();
+    }
+
+    string getExamSubject(int examID) const {
+        const Exam& exam = requireExam(examID);
+        return exam.getSubject();
+    }
+
+    // Rooms and bookings; changes are written by saveExamsToFile()
+    ExamScheduler& getScheduler() { return loadSchedule(); }
+    const ExamScheduler& getScheduler() const { return loadSchedule(); }
+
+    void addRoom(const string& name, int capacity) {
+        loadSchedule().addRoom(name, capacity);
+        editMade();
+    }
+
+    // Books the exam's full duration from start (ScheduleTime minutes) in room
+    // for the cohort; false with the clashes when it does not fit
+    bool scheduleExam(int examID, int64_t start, const string& room, vector<int> cohort,
+                      vector<ScheduleConflict>& conflicts) {
+        int duration = getExamDuration(examID);
+        if (duration <= 0) throw ExamException("Exam " + to_string(examID) + " has no duration to schedule");
+        bool scheduled = loadSchedule().schedule(examID, start, start + duration, room, move(cohort), conflicts);
+        if (scheduled) editMade();
+        return scheduled;
+    }
+
+    // Places every listed exam (examID, cohort) into one of the periods; see
+    // ExamScheduler::scheduleWeek
+    ExamScheduler::WeekReport scheduleExamWeek(const vector<pair<int, vector<int>>>& exams,
+                                               const vector<int64_t>& periodStarts) {
+        vector<ExamScheduler::WeekRequest> requests;
+        requests.reserve(exams.size());
+        for (const auto& [examID, cohort] : exams)
+            requests.push_back({examID, getExamDuration(examID), cohort});
+        ExamScheduler::WeekReport report = loadSchedule().scheduleWeek(move(requests), periodStarts);
+        editMade();
+        return report;
+    }
+
+    void setCacheCapacity(size_t capacity) { cache.setCapacity(capacity); }
+    size_t getCacheHits() const { return cache.getHits(); }
+    size_t getCacheMisses() const { return cache.getMisses(); }
+    size_t getCacheEvictions() const { return cache.getEvictions(); }
+    size_t getCachedExamCount() const { return cache.size(); }
+
+    // Writes only what changed since the last save; returns the number of exam
+    // shards written (0 when nothing was edited)
+    size_t saveExamsToFile() const {
+        openStore();
+        size_t before = shardWrites;
+        cache.forEach([this](int, Exam& exam) { flushExam(exam); });
+        if (metaDirty || pinLogRecords) writeMeta();
+        if (scheduleLoaded && scheduler.isDirty()) writeSchedule();
+        editsSinceSave = 0;
+        return shardWrites - before;
+    }
+
+    size_t getShardWriteCount() const { return shardWrites; }
+
+    // Opens the store (migrating exams.json once); reads only the id counters
+    void loadExamsFromFile() {
+        openStore();
     }
 
 };
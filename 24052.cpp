@@ -4,6 +4,7 @@
 #include <fstream>
 #include <chrono>
 #include <thread>
+#include <filesystem>
 
 // Timer class implementation
 void Timer::startTimer(int durationMinutes) {
@@ -58,18 +59,32 @@ void AnswerSheet::updateAnswer(int questionID, string newAnswer) {
 
 void AnswerSheet::removeAnswer(int questionID) {
     answers.erase(questionID);
+    choices.erase(questionID);
 }
 
 map<int, string> AnswerSheet::getAllAnswers() const {
     return answers;
 }
 
+void AnswerSheet::addChoice(int questionID, uint8_t option) {
+    choices[questionID] = option;
+}
+
+int AnswerSheet::getChoice(int questionID) const {
+    auto it = choices.find(questionID);
+    return it != choices.end() ? it->second : -1;
+}
+
+map<int, uint8_t> AnswerSheet::getAllChoices() const {
+    return choices;
+}
+
 // ExamSession class implementation
 ExamSession::ExamSession() 
-    : studentID(0), examID(0), sheet(nullptr), timer(nullptr), isFinished(false) {}
+    : studentID(0), examID(0), sheet(nullptr), timer(nullptr), examImage(emptyExamImage()), isFinished(false) {}
 
 ExamSession::ExamSession(int sid, int eid) 
-    : studentID(sid), examID(eid), isFinished(false) {
+    : studentID(sid), examID(eid), examImage(emptyExamImage()), isFinished(false) {
     // Create new answer sheet and timer for this session
     sheet = new AnswerSheet(sid, eid);
     timer = new Timer();
@@ -77,7 +92,8 @@ ExamSession::ExamSession(int sid, int eid)
     // Load questions from ExamManager
     ExamManager* examManager = ExamManager::getInstance();
     if (examManager->getExam(eid)) {
-        examQuestions = examManager->getExamQuestions(eid);
+        pinExamImage();
+        variant = ExamVariant::forStudent(*examImage, sid);
     }
 }
 
@@ -106,7 +122,8 @@ void ExamSession::startExam(int sid, int eid) {
         int duration = examManager->getExamDuration(eid);
         
         // Load questions from ExamManager
-        examQuestions = examManager->getExamQuestions(eid);
+        pinExamImage();
+        variant = ExamVariant::forStudent(*examImage, sid);
         
         // Start the timer
         timer->startTimer(duration);
@@ -119,6 +136,63 @@ void ExamSession::startExam(int sid, int eid) {
     }
 }
 
+// The exam's compiled image; sessions read question text straight from it.
+// Pinning the version keeps later edits from changing what this student sees
+// or is graded against
+void ExamSession::pinExamImage() {
+    ExamManager* examManager = ExamManager::getInstance();
+    releaseExamVersion();
+    examImage = examManager->getExamImage(examID);
+    examVersion = examImage->getVersion();
+    if (examImage->isOpen()) {
+        examManager->pinVersion(examID, examVersion);
+        versionPinned = true;
+    }
+}
+
+// Only files without a recorded version use the current one. A recorded
+// version that was reclaimed leaves the session without an image: its stored
+// choices must never be checked against a newer key
+void ExamSession::loadExamImage(int version) {
+    ExamManager* examManager = ExamManager::getInstance();
+    examVersion = version;
+    if (version < 0) {
+        examImage = examManager->getExamImage(examID);
+        examVersion = examImage->getVersion();
+        return;
+    }
+    try {
+        examImage = examManager->getExamImage(examID, version);
+    } catch (const ExamException&) {
+        examImage = emptyExamImage();
+        versionPinned = false;
+    }
+}
+
+// Called once the session is graded; the version's pack can then be reclaimed
+void ExamSession::releaseExamVersion() {
+    if (!versionPinned) return;
+    ExamManager::getInstance()->releaseVersion(examID, examVersion);
+    versionPinned = false;
+}
+
+// Only questions in this student's variant
+bool ExamSession::findQuestion(int questionID, ExamImage::QuestionView& out) const {
+    return examImage->find(questionID, out) && variant.includes(*examImage, questionID);
+}
+
+// Stored answers that do not name an option keep their place as INVALID_CHOICE
+void ExamSession::recordAnswer(int questionID, const string& answer) {
+    ExamImage::QuestionView question;
+    if (findQuestion(questionID, question) && question.isChoice()) {
+        uint8_t order[256];
+        int choice = question.resolveChoice(answer, variant.optionOrder(question, order));
+        sheet->addChoice(questionID, choice >= 0 ? static_cast<uint8_t>(choice) : MCQ::INVALID_CHOICE);
+    } else {
+        sheet->addAnswer(questionID, answer);
+    }
+}
+
 void ExamSession::submitAnswer(int questionID, string answer) {
     if (isFinished) {
         cout << "Cannot submit answer: Exam is already finished." << endl;
@@ -126,7 +200,23 @@ void ExamSession::submitAnswer(int questionID, string answer) {
     }
     
     if (sheet) {
-        sheet->addAnswer(questionID, answer);
+        ExamImage::QuestionView question;
+        if (!findQuestion(questionID, question)) {
+            cout << "Question " << questionID << " is not part of your exam." << endl;
+            return;
+        }
+        uint8_t order[256];
+        if (question.isChoice() && question.resolveChoice(answer, variant.optionOrder(question, order)) < 0) {
+            cout << "Invalid option. Enter the option letter or its exact text." << endl;
+            return;
+        }
+        if (!question.acceptsText(answer)) {
+            cout << (question.getType() == ExamImage::NUMERIC_TYPE
+                         ? "Invalid answer. Enter a number."
+                         : "Invalid answer. Enter the letters of every option you pick, e.g. A,C.") << endl;
+            return;
+        }
+        recordAnswer(questionID, answer);
         cout << "Answer submitted for question " << questionID << endl;
     } else {
         cout << "Answer sheet not initialized." << endl;
@@ -159,14 +249,31 @@ void ExamSession::viewRemainingTime() {
 
 void ExamSession::displayExamQuestions() {
     cout << "\n--- Exam Questions ---\n";
-    for (const auto& question : examQuestions) {
-        question->displayQuestion();
+    if (isVersionReclaimed()) {
+        cout << "The version of this exam you sat (" << examVersion << ") is no longer available." << endl;
+        return;
+    }
+    uint8_t order[256];
+    for (uint32_t slot : variant.questionOrder(*examImage)) {
+        ExamImage::QuestionView question = examImage->at(slot);
+        const uint8_t* optionOrder = variant.optionOrder(question, order);
+        question.displayQuestion(optionOrder);
         
         // Show current answer if one exists
         if (sheet) {
-            string currentAnswer = sheet->getAnswer(question->getQuestionID());
-            if (!currentAnswer.empty()) {
-                cout << "Your current answer: " << currentAnswer << endl;
+            int qID = question.getQuestionID();
+            if (question.isChoice()) {
+                int choice = sheet->getChoice(qID);
+                if (choice >= 0) {
+                    cout << "Your current answer: ";
+                    question.printChoice(cout, static_cast<uint8_t>(choice), optionOrder);
+                    cout << endl;
+                }
+            } else {
+                string currentAnswer = sheet->getAnswer(qID);
+                if (!currentAnswer.empty()) {
+                    cout << "Your current answer: " << currentAnswer << endl;
+                }
             }
         }
         cout << "------------------------\n";
@@ -175,19 +282,39 @@ void ExamSession::displayExamQuestions() {
 
 void ExamSession::displayExamResults() {
     cout << "\n--- Exam Results for Student " << studentID << " ---\n";
+    if (isVersionReclaimed()) {
+        cout << "Exam version " << examVersion << " was reclaimed after grading; "
+             << "your saved result still holds the score." << endl;
+        return;
+    }
     if (sheet) {
         auto allAnswers = sheet->getAllAnswers();
-        for (const auto& question : examQuestions) {
-            int qID = question->getQuestionID();
-            cout << "Question " << qID << ": " << question->getQuestionText() << endl;
+        uint8_t order[256];
+        for (uint32_t slot : variant.questionOrder(*examImage)) {
+            ExamImage::QuestionView question = examImage->at(slot);
+            const uint8_t* optionOrder = variant.optionOrder(question, order);
+            int qID = question.getQuestionID();
+            cout << "Question " << qID << ": " << question.getText() << endl;
             
+            int choice = sheet->getChoice(qID);
             auto it = allAnswers.find(qID);
-            if (it != allAnswers.end()) {
+            if (question.isChoice() && choice >= 0) {
+                cout << "Your answer: ";
+                question.printChoice(cout, static_cast<uint8_t>(choice), optionOrder);
+                cout << endl << "Correct answer: ";
+                question.printChoice(cout, question.getCorrectOption(), optionOrder);
+                cout << endl;
+                cout << "Result: " << (choice == question.getCorrectOption() ? "Correct" : "Incorrect") << endl;
+            } else if (!question.isChoice() && it != allAnswers.end()) {
                 cout << "Your answer: " << it->second << endl;
-                cout << "Correct answer: " << question->getCorrectAnswer() << endl;
+                cout << "Correct answer: " << question.getAnswer() << endl;
                 
-                bool isCorrect = question->checkAnswer(it->second);
-                cout << "Result: " << (isCorrect ? "Correct" : "Incorrect") << endl;
+                double credit = question.creditFor(it->second);
+                cout << "Result: ";
+                if (credit == 1) cout << "Correct";
+                else if (credit > 0) cout << "Partially correct (" << static_cast<int>(credit * 100) << "%)";
+                else cout << "Incorrect";
+                cout << endl;
             } else {
                 cout << "No answer provided" << endl;
             }
@@ -203,9 +330,22 @@ void ExamSession::saveSessionToFile() const {
     j["studentID"] = studentID;
     j["examID"] = examID;
     j["isFinished"] = isFinished;
+    j["variantSeed"] = variant.getSeed();
+    j["examVersion"] = examVersion;
+    j["versionPinned"] = versionPinned;
     
+    // Keyed by question id: MCQ choices as option indices, other answers as text
     if (sheet) {
-        j["answers"] = sheet->getAllAnswers();
+        json choices = json::object();
+        for (const auto& [qID, option] : sheet->getAllChoices()) {
+            choices[to_string(qID)] = option;
+        }
+        json answers = json::object();
+        for (const auto& [qID, text] : sheet->getAllAnswers()) {
+            answers[to_string(qID)] = text;
+        }
+        j["choices"] = choices;
+        j["answers"] = answers;
     }
     
     std::ofstream file("session_" + std::to_string(studentID) + "_" + std::to_string(examID) + ".json");
@@ -234,17 +374,28 @@ void ExamSession::loadSessionFromFile(int sid, int eid) {
             sheet = new AnswerSheet(studentID, examID);
         }
         
+        // The exact version the student started on (needed to tell MCQ answers apart)
+        versionPinned = j.value("versionPinned", false);
+        loadExamImage(j.value("examVersion", -1));
+        variant = ExamVariant(j.value("variantSeed", uint64_t(0)));  // older files: the exam as written
+        
         // Load answers
-        auto answersJson = j["answers"];
-        for (auto it = answersJson.begin(); it != answersJson.end(); ++it) {
-            int qID = stoi(it.key());
-            string ans = it.value();
-            sheet->addAnswer(qID, ans);
+        if (j.contains("choices")) {
+            for (auto it = j["choices"].begin(); it != j["choices"].end(); ++it) {
+                sheet->addChoice(stoi(it.key()), it.value().get<uint8_t>());
+            }
+        }
+        const json& answersJson = j.value("answers", json::object());
+        if (answersJson.is_array()) {
+            // Older files: [[questionID, "answer text"], ...]
+            for (const auto& pair : answersJson) {
+                recordAnswer(pair.at(0).get<int>(), pair.at(1).get<string>());
+            }
+        } else {
+            for (auto it = answersJson.begin(); it != answersJson.end(); ++it) {
+                recordAnswer(stoi(it.key()), it.value().get<string>());
+            }
         }
-        
-        // Load questions from ExamManager
-        ExamManager* examManager = ExamManager::getInstance();
-        examQuestions = examManager->getExamQuestions(examID);
         
         cout << "Session loaded from file." << endl;
     } else {
@@ -259,9 +410,9 @@ void ExamSession::loadSessionFromFile(int sid, int eid) {
             timer = new Timer();
         }
         
-        // Load questions from ExamManager
-        ExamManager* examManager = ExamManager::getInstance();
-        examQuestions = examManager->getExamQuestions(examID);
+        // Load questions from ExamManager; not pinned until it is started and saved
+        loadExamImage(-1);
+        variant = ExamVariant::forStudent(*examImage, sid);
     }
 }
 
@@ -279,8 +430,7 @@ ostream& operator<<(ostream &out, const ExamSession &session) {
     out << endl;
     
     if (session.sheet) {
-        auto answers = session.sheet->getAllAnswers();
-        out << "Questions answered: " << answers.size() << endl;
+        out << "Questions answered: " << session.sheet->getAnswerCount() << endl;
     }
     return out;
 }
@@ -296,17 +446,39 @@ void SessionManager::startSession(int studentID, int examID) {
             return;
         }
     }
+
+    EnrollmentManager* enrollment = EnrollmentManager::getInstance();
+    if (!enrollment->mayStart(studentID, examID)) {
+        cout << "Student " << studentID << " is not enrolled in exam " << examID << endl;
+        return;
+    }
+
+    // A session saved by an earlier run already holds a pin on its version:
+    // resume it instead of pinning a second time
+    string path = "session_" + to_string(studentID) + "_" + to_string(examID) + ".json";
+    if (filesystem::exists(path)) {
+        ExamSession* saved = getSession(studentID, examID);
+        if (saved && (saved->isExamFinished() || !saved->isVersionReclaimed())) {
+            cout << (saved->isExamFinished() ? "Session already finished for student " : "Resuming session for student ")
+                 << studentID << " and exam " << examID << endl;
+            return;
+        }
+        // Unfinished, and the version it started on is gone: start over on the current one
+        if (saved) discardSession(studentID, examID);
+    }
     
     // Create new session
     ExamSession* newSession = new ExamSession(studentID, examID);
     newSession->startExam(studentID, examID);
     sessions.push_back(newSession);
+    enrollment->markStarted(studentID, examID);
 }
 
 void SessionManager::endSession(int studentID, int examID) {
     for (auto it = sessions.begin(); it != sessions.end(); ++it) {
         if ((*it)->getStudentID() == studentID && (*it)->getExamID() == examID) {
             (*it)->finishExam();
+            EnrollmentManager::getInstance()->markFinished(studentID, examID);
             // We don't delete the session yet as it might be needed for grading
             return;
         }
@@ -314,6 +486,30 @@ void SessionManager::endSession(int studentID, int examID) {
     cout << "No active session found for student " << studentID << " and exam " << examID << endl;
 }
 
+// An abandoned attempt: the student never finishes it, so nothing will grade it
+// and release its exam version. Finished sessions stay until they are graded.
+bool SessionManager::discardSession(int studentID, int examID) {
+    string path = "session_" + to_string(studentID) + "_" + to_string(examID) + ".json";
+    // getSession would open a fresh session when there is nothing to discard
+    ExamSession* session = doesSessionExist(studentID, examID) || filesystem::exists(path)
+        ? getSession(studentID, examID) : nullptr;
+    if (!session) {
+        cout << "No session found for student " << studentID << " and exam " << examID << endl;
+        return false;
+    }
+    if (session->isExamFinished()) {
+        cout << "Session is finished and waiting to be graded; it cannot be discarded." << endl;
+        return false;
+    }
+    session->releaseExamVersion();
+    error_code ec;
+    filesystem::remove(path, ec);
+    sessions.erase(find(sessions.begin(), sessions.end(), session));
+    delete session;
+    cout << "Session discarded for student " << studentID << " and exam " << examID << endl;
+    return true;
+}
+
 ExamSession* SessionManager::getSession(int studentID, int examID) {
     for (auto session : sessions) {
         if (session->getStudentID() == studentID && session->getExamID() == examID) {
@@ -328,6 +524,12 @@ ExamSession* SessionManager::getSession(int studentID, int examID) {
     // Add to sessions if successfully loaded
     if (newSession->getStudentID() == studentID && newSession->getExamID() == examID) {
         sessions.push_back(newSession);
+        EnrollmentManager* enrollment = EnrollmentManager::getInstance();
+        if (newSession->isExamFinished()) {
+            enrollment->markFinished(studentID, examID);
+        } else {
+            enrollment->markStarted(studentID, examID);
+        }
         return newSession;
     } else {
         delete newSession;
@@ -361,4 +563,400 @@ void SessionManager::displayActiveExamSessions() const {
     for (auto session : sessions) {
         cout << *session;
     }
-}
\ No newline at end of file
+}
+// IdBitmap implementation
+bool IdBitmap::Chunk::contains(uint16_t low) const {
+    if (isBitset()) return (bits[low >> 6] >> (low & 63)) & 1;
+    return binary_search(array.begin(), array.end(), low);
+}
+
+void IdBitmap::Chunk::toBitset() {
+    if (isBitset()) return;
+    bits.assign(BITSET_WORDS, 0);
+    for (uint16_t low : array) bits[low >> 6] |= uint64_t(1) << (low & 63);
+    array.clear();
+    array.shrink_to_fit();
+}
+
+void IdBitmap::Chunk::normalize() {
+    if (isBitset() && count <= ARRAY_MAX) {
+        array.clear();
+        array.reserve(count);
+        for (size_t w = 0; w < BITSET_WORDS; ++w) {
+            for (uint64_t word = bits[w]; word; word &= word - 1) {
+                array.push_back(static_cast<uint16_t>(w * 64 + countTrailingZeros64(word)));
+            }
+        }
+        bits.clear();
+        bits.shrink_to_fit();
+    } else if (!isBitset() && count > ARRAY_MAX) {
+        toBitset();
+    }
+}
+
+IdBitmap::Chunk* IdBitmap::findChunk(uint16_t key) {
+    auto it = lower_bound(chunks.begin(), chunks.end(), key,
+                          [](const Chunk& c, uint16_t k) { return c.key < k; });
+    return (it != chunks.end() && it->key == key) ? &*it : nullptr;
+}
+
+const IdBitmap::Chunk* IdBitmap::findChunk(uint16_t key) const {
+    return const_cast<IdBitmap*>(this)->findChunk(key);
+}
+
+void IdBitmap::add(int id) {
+    if (id < 0) return;
+    uint16_t key = static_cast<uint16_t>(static_cast<uint32_t>(id) >> 16);
+    uint16_t low = static_cast<uint16_t>(id & 0xFFFF);
+    auto it = lower_bound(chunks.begin(), chunks.end(), key,
+                          [](const Chunk& c, uint16_t k) { return c.key < k; });
+    if (it == chunks.end() || it->key != key) {
+        it = chunks.insert(it, Chunk());
+        it->key = key;
+    }
+    if (it->isBitset()) {
+        uint64_t& word = it->bits[low >> 6];
+        uint64_t mask = uint64_t(1) << (low & 63);
+        if (word & mask) return;
+        word |= mask;
+    } else {
+        auto pos = lower_bound(it->array.begin(), it->array.end(), low);
+        if (pos != it->array.end() && *pos == low) return;
+        it->array.insert(pos, low);
+    }
+    ++it->count;
+    it->normalize();
+}
+
+void IdBitmap::addRange(int first, int last) {
+    for (int64_t id = max(first, 0); id <= last; ++id) add(static_cast<int>(id));  // 64-bit so last == INT_MAX ends
+}
+
+bool IdBitmap::remove(int id) {
+    if (id < 0) return false;
+    uint16_t key = static_cast<uint16_t>(static_cast<uint32_t>(id) >> 16);
+    uint16_t low = static_cast<uint16_t>(id & 0xFFFF);
+    Chunk* c = findChunk(key);
+    if (!c || !c->contains(low)) return false;
+    if (c->isBitset()) {
+        c->bits[low >> 6] &= ~(uint64_t(1) << (low & 63));
+    } else {
+        c->array.erase(lower_bound(c->array.begin(), c->array.end(), low));
+    }
+    if (--c->count == 0) {
+        chunks.erase(chunks.begin() + (c - chunks.data()));
+    } else {
+        c->normalize();
+    }
+    return true;
+}
+
+bool IdBitmap::contains(int id) const {
+    if (id < 0) return false;
+    const Chunk* c = findChunk(static_cast<uint16_t>(static_cast<uint32_t>(id) >> 16));
+    return c && c->contains(static_cast<uint16_t>(id & 0xFFFF));
+}
+
+size_t IdBitmap::cardinality() const {
+    size_t total = 0;
+    for (const Chunk& c : chunks) total += c.count;
+    return total;
+}
+
+IdBitmap::Chunk IdBitmap::intersect(const Chunk& a, const Chunk& b) {
+    Chunk out;
+    out.key = a.key;
+    if (a.isBitset() && b.isBitset()) {
+        out.bits.resize(BITSET_WORDS);
+        for (size_t w = 0; w < BITSET_WORDS; ++w) {
+            out.bits[w] = a.bits[w] & b.bits[w];
+            out.count += popcount64(out.bits[w]);
+        }
+    } else if (!a.isBitset() && !b.isBitset()) {
+        set_intersection(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(),
+                         back_inserter(out.array));
+        out.count = out.array.size();
+    } else {
+        const Chunk& sparse = a.isBitset() ? b : a;
+        const Chunk& dense = a.isBitset() ? a : b;
+        for (uint16_t low : sparse.array) {
+            if (dense.contains(low)) out.array.push_back(low);
+        }
+        out.count = out.array.size();
+    }
+    out.normalize();
+    return out;
+}
+
+IdBitmap::Chunk IdBitmap::unite(const Chunk& a, const Chunk& b) {
+    Chunk out;
+    out.key = a.key;
+    if (!a.isBitset() && !b.isBitset() && a.count + b.count <= ARRAY_MAX) {
+        set_union(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(),
+                  back_inserter(out.array));
+        out.count = out.array.size();
+        return out;
+    }
+    out = a;
+    out.toBitset();
+    if (b.isBitset()) {
+        for (size_t w = 0; w < BITSET_WORDS; ++w) out.bits[w] |= b.bits[w];
+    } else {
+        for (uint16_t low : b.array) out.bits[low >> 6] |= uint64_t(1) << (low & 63);
+    }
+    out.count = 0;
+    for (uint64_t word : out.bits) out.count += popcount64(word);
+    out.normalize();
+    return out;
+}
+
+IdBitmap::Chunk IdBitmap::subtract(const Chunk& a, const Chunk& b) {
+    Chunk out;
+    out.key = a.key;
+    if (!a.isBitset()) {
+        for (uint16_t low : a.array) {
+            if (!b.contains(low)) out.array.push_back(low);
+        }
+        out.count = out.array.size();
+        return out;
+    }
+    out.bits = a.bits;
+    if (b.isBitset()) {
+        for (size_t w = 0; w < BITSET_WORDS; ++w) out.bits[w] &= ~b.bits[w];
+    } else {
+        for (uint16_t low : b.array) out.bits[low >> 6] &= ~(uint64_t(1) << (low & 63));
+    }
+    for (uint64_t word : out.bits) out.count += popcount64(word);
+    out.normalize();
+    return out;
+}
+
+IdBitmap IdBitmap::operator&(const IdBitmap& other) const {
+    IdBitmap result;
+    size_t i = 0, j = 0;
+    while (i < chunks.size() && j < other.chunks.size()) {
+        if (chunks[i].key < other.chunks[j].key) {
+            ++i;
+        } else if (other.chunks[j].key < chunks[i].key) {
+            ++j;
+        } else {
+            Chunk c = intersect(chunks[i++], other.chunks[j++]);
+            if (c.count) result.chunks.push_back(move(c));
+        }
+    }
+    return result;
+}
+
+IdBitmap IdBitmap::operator|(const IdBitmap& other) const {
+    IdBitmap result;
+    size_t i = 0, j = 0;
+    while (i < chunks.size() || j < other.chunks.size()) {
+        if (j == other.chunks.size() || (i < chunks.size() && chunks[i].key < other.chunks[j].key)) {
+            result.chunks.push_back(chunks[i++]);
+        } else if (i == chunks.size() || other.chunks[j].key < chunks[i].key) {
+            result.chunks.push_back(other.chunks[j++]);
+        } else {
+            result.chunks.push_back(unite(chunks[i++], other.chunks[j++]));
+        }
+    }
+    return result;
+}
+
+IdBitmap IdBitmap::andNot(const IdBitmap& other) const {
+    IdBitmap result;
+    size_t j = 0;
+    for (const Chunk& c : chunks) {
+        while (j < other.chunks.size() && other.chunks[j].key < c.key) ++j;
+        if (j < other.chunks.size() && other.chunks[j].key == c.key) {
+            Chunk diff = subtract(c, other.chunks[j]);
+            if (diff.count) result.chunks.push_back(move(diff));
+        } else {
+            result.chunks.push_back(c);
+        }
+    }
+    return result;
+}
+
+vector<int> IdBitmap::toVector() const {
+    vector<int> ids;
+    ids.reserve(cardinality());
+    forEach([&](int id) { ids.push_back(id); });
+    return ids;
+}
+
+json IdBitmap::toJson() const {
+    return toVector();
+}
+
+IdBitmap IdBitmap::fromJson(const json& j) {
+    IdBitmap bitmap;
+    for (const auto& id : j) bitmap.add(id.get<int>());
+    return bitmap;
+}
+
+// EnrollmentManager implementation
+EnrollmentManager* EnrollmentManager::instance = nullptr;
+
+void EnrollmentManager::enroll(int studentID, int examID) {
+    ExamRoster& roster = rosters[examID];
+    roster.restricted = true;
+    roster.enrolled.add(studentID);
+    studentExams[studentID].add(examID);
+}
+
+size_t EnrollmentManager::enrollMany(int examID, const IdBitmap& studentIDs) {
+    ExamRoster& roster = rosters[examID];
+    roster.restricted = true;
+    size_t before = roster.enrolled.cardinality();
+    roster.enrolled |= studentIDs;
+    studentIDs.forEach([&](int studentID) { studentExams[studentID].add(examID); });
+    return roster.enrolled.cardinality() - before;
+}
+
+void EnrollmentManager::unenroll(int studentID, int examID) {
+    auto it = rosters.find(examID);
+    if (it != rosters.end()) it->second.enrolled.remove(studentID);
+    auto st = studentExams.find(studentID);
+    if (st != studentExams.end()) {
+        st->second.remove(examID);
+        if (st->second.empty()) studentExams.erase(st);
+    }
+}
+
+void EnrollmentManager::removeExam(int examID) {
+    auto it = rosters.find(examID);
+    if (it == rosters.end()) return;
+    it->second.enrolled.forEach([&](int studentID) {
+        auto st = studentExams.find(studentID);
+        if (st != studentExams.end()) {
+            st->second.remove(examID);
+            if (st->second.empty()) studentExams.erase(st);
+        }
+    });
+    rosters.erase(it);
+}
+
+bool EnrollmentManager::hasRoster(int examID) const {
+    auto it = rosters.find(examID);
+    return it != rosters.end() && it->second.restricted;
+}
+
+bool EnrollmentManager::isEnrolled(int studentID, int examID) const {
+    auto it = rosters.find(examID);
+    return it != rosters.end() && it->second.enrolled.contains(studentID);
+}
+
+bool EnrollmentManager::mayStart(int studentID, int examID) const {
+    return !hasRoster(examID) || isEnrolled(studentID, examID);
+}
+
+void EnrollmentManager::markStarted(int studentID, int examID) {
+    rosters[examID].started.add(studentID);
+}
+
+void EnrollmentManager::markFinished(int studentID, int examID) {
+    ExamRoster& roster = rosters[examID];
+    roster.started.add(studentID);
+    roster.finished.add(studentID);
+}
+
+IdBitmap EnrollmentManager::getEnrolled(int examID) const {
+    auto it = rosters.find(examID);
+    return it != rosters.end() ? it->second.enrolled : IdBitmap();
+}
+
+IdBitmap EnrollmentManager::getStarted(int examID) const {
+    auto it = rosters.find(examID);
+    return it != rosters.end() ? it->second.started : IdBitmap();
+}
+
+IdBitmap EnrollmentManager::getFinished(int examID) const {
+    auto it = rosters.find(examID);
+    return it != rosters.end() ? it->second.finished : IdBitmap();
+}
+
+IdBitmap EnrollmentManager::getNotStarted(int examID) const {
+    auto it = rosters.find(examID);
+    return it != rosters.end() ? it->second.enrolled.andNot(it->second.started) : IdBitmap();
+}
+
+IdBitmap EnrollmentManager::getInProgress(int examID) const {
+    auto it = rosters.find(examID);
+    return it != rosters.end() ? it->second.started.andNot(it->second.finished) : IdBitmap();
+}
+
+IdBitmap EnrollmentManager::getExamsForStudent(int studentID) const {
+    auto it = studentExams.find(studentID);
+    return it != studentExams.end() ? it->second : IdBitmap();
+}
+
+IdBitmap EnrollmentManager::getAllFinishedStudents() const {
+    IdBitmap all;
+    for (const auto& [examID, roster] : rosters) all |= roster.finished;
+    return all;
+}
+
+void EnrollmentManager::displayEnrollmentStatus(int examID) const {
+    cout << "\n--- Enrollment for Exam ID " << examID << " ---" << endl;
+    if (!hasRoster(examID)) {
+        cout << "No roster: the exam is open to every student." << endl;
+    } else {
+        cout << "Enrolled: " << getEnrolled(examID).cardinality() << endl;
+    }
+    IdBitmap notStarted = getNotStarted(examID);
+    cout << "Not started: " << notStarted.cardinality() << endl;
+    cout << "In progress: " << getInProgress(examID).cardinality() << endl;
+    cout << "Finished: " << getFinished(examID).cardinality() << endl;
+
+    // Name the stragglers when the list is short enough to read
+    if (!notStarted.empty() && notStarted.cardinality() <= 50) {
+        cout << "Yet to start:";
+        notStarted.forEach([](int studentID) { cout << " " << studentID; });
+        cout << endl;
+    }
+}
+
+void EnrollmentManager::saveToFile() const {
+    json j = json::object();
+    for (const auto& [examID, roster] : rosters) {
+        j[to_string(examID)] = {
+            {"restricted", roster.restricted},
+            {"enrolled", roster.enrolled.toJson()},
+            {"started", roster.started.toJson()},
+            {"finished", roster.finished.toJson()}
+        };
+    }
+
+    ofstream file("enrollments.json");
+    if (file.is_open()) {
+        file << j.dump(4);
+    } else {
+        cout << "Failed to save enrollments to file." << endl;
+    }
+}
+
+void EnrollmentManager::loadFromFile() {
+    ifstream file("enrollments.json");
+    if (!file.is_open()) return;  // nothing enrolled yet
+
+    json j;
+    try {
+        file >> j;
+    } catch (const json::exception& e) {
+        cout << "Failed to read enrollments.json: " << e.what() << endl;
+        return;
+    }
+
+    rosters.clear();
+    studentExams.clear();
+    for (auto it = j.begin(); it != j.end(); ++it) {
+        int examID = stoi(it.key());
+        ExamRoster& roster = rosters[examID];
+        roster.enrolled = IdBitmap::fromJson(it.value().value("enrolled", json::array()));
+        roster.started = IdBitmap::fromJson(it.value().value("started", json::array()));
+        roster.finished = IdBitmap::fromJson(it.value().value("finished", json::array()));
+        // Files written before the flag existed only kept rosters with students in them
+        roster.restricted = it.value().value("restricted", !roster.enrolled.empty());
+        roster.enrolled.forEach([&](int studentID) { studentExams[studentID].add(examID); });
+    }
+}
@@ -9,6 +9,8 @@
 #include <fstream>
 #include <algorithm>
 #include <memory>
+#include <cstdint>
+#include <unordered_map>
 #include "json.hpp"
 #include "24043.h" // Include Exam Module
 
@@ -43,14 +45,19 @@ public:
 };
 
 // ---------- IAnswerSheet Interface ----------
+// MCQ answers are option indices (choices); answers to other questions are text
 class IAnswerSheet {
 public:
     virtual ~IAnswerSheet() {}
     virtual void addAnswer(int questionID, string answer) = 0;
     virtual string getAnswer(int questionID) const = 0;
     virtual void updateAnswer(int questionID, string newAnswer) = 0;
-    virtual void removeAnswer(int questionID) = 0;
-    virtual map<int, string> getAllAnswers() const = 0;
+    virtual void removeAnswer(int questionID) = 0;      // text answer or choice
+    virtual map<int, string> getAllAnswers() const = 0; // text answers only
+    virtual void addChoice(int questionID, uint8_t option) = 0;
+    virtual int getChoice(int questionID) const = 0;    // -1 when not answered
+    virtual map<int, uint8_t> getAllChoices() const = 0;
+    virtual size_t getAnswerCount() const = 0;
     virtual int getStudentID() const = 0;
     virtual int getExamID() const = 0;
 };
@@ -59,6 +66,7 @@ public:
 class AnswerSheet : public IAnswerSheet {
 private:
     map<int, string> answers;
+    map<int, uint8_t> choices;
     int studentID;
     int examID;
 
@@ -70,6 +78,10 @@ public:
     void updateAnswer(int questionID, string newAnswer) override;
     void removeAnswer(int questionID) override;
     map<int, string> getAllAnswers() const override;
+    void addChoice(int questionID, uint8_t option) override;
+    int getChoice(int questionID) const override;
+    map<int, uint8_t> getAllChoices() const override;
+    size_t getAnswerCount() const override { return answers.size() + choices.size(); }
     int getStudentID() const override { return studentID; }
     int getExamID() const override { return examID; }
 };
@@ -96,9 +108,17 @@ private:
     int examID;
     IAnswerSheet* sheet;
     ITimer* timer;
-    vector<shared_ptr<Question>> examQuestions;
+    shared_ptr<const ExamImage> examImage;  // mapped once, shared with every session of the exam
+    ExamVariant variant;                    // this student's question and option order
+    int examVersion = -1;                   // version the student sat; -1 for older files
+    bool versionPinned = false;             // holds a pin on examImage's version until graded
     bool isFinished;
 
+    bool findQuestion(int questionID, ExamImage::QuestionView& out) const;
+    void pinExamImage();                    // current version, pinned: new sessions
+    void loadExamImage(int version);        // the version a saved session started on
+    void recordAnswer(int questionID, const string& answer);  // choice for MCQs, text otherwise
+
 public:
     ExamSession();
     ExamSession(int studentID, int examID);
@@ -113,6 +133,12 @@ public:
     void saveSessionToFile() const override;
     void loadSessionFromFile(int studentID, int examID) override;
     IAnswerSheet* getAnswerSheet() const override { return sheet; }
+    const shared_ptr<const ExamImage>& getExamImage() const { return examImage; }
+    const ExamVariant& getVariant() const { return variant; }
+    int getExamVersion() const { return examVersion; }
+    // The recorded version is gone (released after grading); answers can no longer be checked
+    bool isVersionReclaimed() const { return examVersion >= 0 && !examImage->isOpen(); }
+    void releaseExamVersion();
     
     bool isExamFinished() const { return isFinished; }
     int getStudentID() const { return studentID; }
@@ -138,6 +164,7 @@ public:
     
     void startSession(int studentID, int examID);
     void endSession(int studentID, int examID);
+    bool discardSession(int studentID, int examID);  // unfinished only; drops its file and pin
     ExamSession* getSession(int studentID, int examID);
     void saveAllSessions();
     bool doesSessionExist(int studentID, int examID);
@@ -145,4 +172,122 @@ public:
     vector<ExamSession*> getAllSessions() const { return sessions; }
 };
 
+// ---------- IdBitmap ----------
+// Compressed set of non-negative ids (roaring layout). Ids are split into
+// 65536-wide chunks keyed by their high 16 bits; a chunk keeps its low bits as
+// a sorted uint16 array while sparse and switches to a 1024-word bitset once it
+// holds more than ARRAY_MAX ids. Set operations work chunk by chunk, so a
+// 100k-student cohort is two or three bitsets and a difference is a few
+// thousand word operations.
+class IdBitmap {
+private:
+    static constexpr size_t ARRAY_MAX = 4096;
+    static constexpr size_t BITSET_WORDS = 1024;
+
+    struct Chunk {
+        uint16_t key = 0;
+        uint32_t count = 0;
+        vector<uint16_t> array;  // sorted low bits, used while count <= ARRAY_MAX
+        vector<uint64_t> bits;   // BITSET_WORDS words once dense; empty otherwise
+
+        bool isBitset() const { return !bits.empty(); }
+        bool contains(uint16_t low) const;
+        void toBitset();
+        void normalize();  // picks the representation that fits count
+    };
+    vector<Chunk> chunks;  // sorted by key
+
+    Chunk* findChunk(uint16_t key);
+    const Chunk* findChunk(uint16_t key) const;
+    static Chunk intersect(const Chunk& a, const Chunk& b);
+    static Chunk unite(const Chunk& a, const Chunk& b);
+    static Chunk subtract(const Chunk& a, const Chunk& b);
+
+public:
+    void add(int id);
+    void addRange(int first, int last);  // inclusive
+    bool remove(int id);
+    bool contains(int id) const;
+    size_t cardinality() const;
+    bool empty() const { return chunks.empty(); }
+    void clear() { chunks.clear(); }
+
+    IdBitmap operator&(const IdBitmap& other) const;  // in both
+    IdBitmap operator|(const IdBitmap& other) const;  // in either
+    IdBitmap andNot(const IdBitmap& other) const;     // in this, not in other
+    IdBitmap& operator|=(const IdBitmap& other) { return *this = *this | other; }
+
+    // Visits ids in ascending order
+    template <typename F>
+    void forEach(F&& visit) const {
+        for (const Chunk& c : chunks) {
+            int high = static_cast<int>(c.key) << 16;
+            if (c.isBitset()) {
+                for (size_t w = 0; w < BITSET_WORDS; ++w) {
+                    for (uint64_t word = c.bits[w]; word; word &= word - 1) {
+                        visit(high | static_cast<int>(w * 64 + countTrailingZeros64(word)));
+                    }
+                }
+            } else {
+                for (uint16_t low : c.array) visit(high | low);
+            }
+        }
+    }
+    vector<int> toVector() const;
+
+    json toJson() const;  // ascending id array
+    static IdBitmap fromJson(const json& j);
+};
+
+// ---------- Singleton EnrollmentManager ----------
+// Records which students may sit which exam, and how far each got. Per exam it
+// keeps bitmaps of enrolled, started and finished students; per student a
+// bitmap of enrolled exams. Exams without a roster stay open to everyone; once
+// a roster exists it stays, even empty, until the exam itself is removed.
+class EnrollmentManager {
+private:
+    static EnrollmentManager* instance;
+
+    struct ExamRoster {
+        IdBitmap enrolled;
+        IdBitmap started;
+        IdBitmap finished;
+        bool restricted = false;  // set by the first enrollment, not by progress marks
+    };
+    map<int, ExamRoster> rosters;                 // examID -> roster
+    unordered_map<int, IdBitmap> studentExams;    // studentID -> enrolled exams
+
+    EnrollmentManager() {}
+
+public:
+    static EnrollmentManager* getInstance() {
+        if (!instance) instance = new EnrollmentManager();
+        return instance;
+    }
+
+    void enroll(int studentID, int examID);
+    size_t enrollMany(int examID, const IdBitmap& studentIDs);  // returns newly enrolled
+    void unenroll(int studentID, int examID);
+    void removeExam(int examID);
+
+    bool hasRoster(int examID) const;
+    bool isEnrolled(int studentID, int examID) const;
+    bool mayStart(int studentID, int examID) const;  // enrolled, or exam has no roster
+
+    void markStarted(int studentID, int examID);
+    void markFinished(int studentID, int examID);
+
+    IdBitmap getEnrolled(int examID) const;
+    IdBitmap getStarted(int examID) const;
+    IdBitmap getFinished(int examID) const;
+    IdBitmap getNotStarted(int examID) const;   // enrolled and not started
+    IdBitmap getInProgress(int examID) const;   // started and not finished
+    IdBitmap getExamsForStudent(int studentID) const;
+    IdBitmap getAllFinishedStudents() const;    // finished any exam
+
+    void displayEnrollmentStatus(int examID) const;
+    void saveToFile() const;
+    void loadFromFile();
+};
+
 #endif // EXAM_SESSION_H
\ No newline at end of file
@@ -0,0 +1,131 @@
+// Benchmark: scoring 1M packed answer sheets against a compiled 100-question key.
+// Build with `make bench`, run ./bench/grading_bench [sheetCount]
+// Compares the AnswerKey kernel with a byte-by-byte loop and with the
+// map-based score()/Exam::checkAnswers paths (run on a sample and scaled up),
+// then scores a mixed True/False, MultiSelect and Numeric exam.
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include "../24043.h"
+
+using namespace std;
+
+template <typename F>
+static double timeMs(F&& f) {
+    auto start = chrono::steady_clock::now();
+    f();
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+    const size_t sheets = argc > 1 ? strtoul(argv[1], nullptr, 10) : 1000000;
+    const size_t questionCount = 100;
+
+    ExamManager* manager = ExamManager::getInstance();
+    int examID = manager->createExam("Benchmark", 60);
+    vector<string> options = {"alpha", "bravo", "charlie", "delta"};
+    mt19937 rng(42);
+    for (size_t i = 0; i < questionCount; ++i) {
+        manager->addMCQuestion(examID, "Question " + to_string(i), static_cast<int>(rng() % 4), options);
+    }
+    const Exam& exam = *manager->getExam(examID);
+    shared_ptr<const AnswerKey> key = exam.getAnswerKey();
+    const size_t width = key->mcqCount();
+
+    // Sheets are packed back to back: one option byte per question, ~10% blank
+    vector<uint8_t> packed(sheets * width);
+    for (auto& code : packed) {
+        unsigned r = rng() % 40;
+        code = r < 4 ? AnswerKey::UNANSWERED : static_cast<uint8_t>(r % 4);
+    }
+
+    size_t kernelTotal = 0, scalarTotal = 0;
+    double kernelMs = timeMs([&] {
+        for (size_t s = 0; s < sheets; ++s) kernelTotal += key->scoreMCQ(&packed[s * width]);
+    });
+    double scalarMs = timeMs([&] {
+        const uint8_t* codes = key->codes();
+        for (size_t s = 0; s < sheets; ++s) {
+            const uint8_t* sheet = &packed[s * width];
+            size_t correct = 0;
+            for (size_t i = 0; i < width; ++i) correct += codes[i] == sheet[i];
+            scalarTotal += correct;
+        }
+    });
+
+    // Map-based paths on a sample: a choice map per sheet, map<int,bool> per checkAnswers call
+    const size_t sample = min<size_t>(sheets, 20000);
+    QuestionSetPtr questions = exam.getQuestions();
+    vector<map<int, uint8_t>> choiceMaps(sample);
+    const map<int, string> noText;
+    for (size_t s = 0; s < sample; ++s) {
+        for (size_t i = 0; i < width; ++i) {
+            uint8_t code = packed[s * width + i];
+            if (code != AnswerKey::UNANSWERED) choiceMaps[s][(*questions)[i]->getQuestionID()] = code;
+        }
+    }
+    size_t legacyTotal = 0;
+    double mapKernelTotal = 0;
+    double legacyMs = timeMs([&] {
+        for (const auto& choices : choiceMaps) {
+            for (const auto& [id, ok] : exam.checkAnswers(choices, noText)) legacyTotal += ok;
+        }
+    });
+    double mapKernelMs = timeMs([&] {
+        for (const auto& choices : choiceMaps) mapKernelTotal += key->score(choices, noText);
+    });
+    size_t sampleKernelTotal = 0;
+    for (size_t s = 0; s < sample; ++s) sampleKernelTotal += key->scoreMCQ(&packed[s * width]);
+
+    double scale = static_cast<double>(sheets) / sample;
+    cout << sheets << " sheets x " << questionCount << " questions\n";
+    cout << "  packed kernel (" <<
+#ifdef __SSE2__
+        "SSE2"
+#else
+        "scalar"
+#endif
+        << "):   " << kernelMs << " ms, " << sheets / (kernelMs / 1000.0) / 1e6 << " M sheets/s\n";
+    cout << "  byte loop:             " << scalarMs << " ms\n";
+    cout << "  key->score(map):       " << mapKernelMs * scale << " ms (scaled from " << sample << ")\n";
+    cout << "  Exam::checkAnswers:    " << legacyMs * scale << " ms (scaled from " << sample << ")\n";
+    bool agree = kernelTotal == scalarTotal && legacyTotal == sampleKernelTotal && mapKernelTotal == sampleKernelTotal;
+    cout << "  totals agree: " << (agree ? "yes" : "NO") << "\n";
+
+    // Mixed objective exam: True/False as choice bytes, MultiSelect letters and
+    // numbers as text parsed in place by the key
+    int mixedID = manager->createExam("Mixed benchmark", 60);
+    vector<string> six = {"a", "b", "c", "d", "e", "f"};
+    for (size_t i = 0; i < questionCount; ++i) {
+        if (i % 3 == 0) manager->addTrueFalseQuestion(mixedID, "Claim " + to_string(i), rng() % 2);
+        else if (i % 3 == 1) manager->addMultiSelectQuestion(mixedID, "Pick " + to_string(i), rng() % 63 + 1, six);
+        else manager->addNumericQuestion(mixedID, "Value " + to_string(i), rng() % 1000, 0.5, 0.001);
+    }
+    const Exam& mixed = *manager->getExam(mixedID);
+    shared_ptr<const AnswerKey> mixedKey = mixed.getAnswerKey();
+    vector<map<int, uint8_t>> mixedChoices(sample);
+    vector<map<int, string>> mixedTexts(sample);
+    for (size_t s = 0; s < sample; ++s) {
+        for (const auto& q : *mixed.getQuestions()) {
+            int id = q->getQuestionID();
+            if (dynamic_cast<const TrueFalse*>(q.get())) mixedChoices[s][id] = static_cast<uint8_t>(rng() % 2);
+            else if (dynamic_cast<const MultiSelect*>(q.get())) mixedTexts[s][id] = MultiSelect::describeMask(rng() % 63 + 1);
+            else mixedTexts[s][id] = to_string(rng() % 1000);
+        }
+    }
+    double mixedTotal = 0;
+    double mixedMs = timeMs([&] {
+        for (size_t s = 0; s < sample; ++s) mixedTotal += mixedKey->score(mixedChoices[s], mixedTexts[s]);
+    });
+    size_t checkedTotal = 0;
+    double checkedMs = timeMs([&] {
+        for (size_t s = 0; s < sample; ++s)
+            for (const auto& [id, ok] : mixed.checkAnswers(mixedChoices[s], mixedTexts[s])) checkedTotal += ok;
+    });
+    cout << "mixed TF/MultiSelect/Numeric, " << sample << " sheets\n";
+    cout << "  key->score (partial credit): " << mixedMs << " ms, " << sample / (mixedMs / 1000.0) / 1e6
+         << " M sheets/s, mean " << mixedTotal / sample << " points\n";
+    cout << "  Exam::checkAnswers:          " << checkedMs << " ms, mean " << double(checkedTotal) / sample << " right\n";
+    return agree ? 0 : 1;
+}
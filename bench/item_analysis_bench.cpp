@@ -0,0 +1,93 @@
+// Benchmark: item analysis (ExamStatistics) over 100k answer sheets x 200 MCQs.
+// Build with `make bench`, run ./bench/item_analysis_bench [sheetCount]
+// Sheets are simulated from a latent ability so items discriminate; they are
+// streamed in packed form, then analyzed. The KR-20 and p-values are checked
+// against a direct row-by-row computation.
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include "../24043.h"
+
+using namespace std;
+
+template <typename F>
+static double timeMs(F&& f) {
+    auto start = chrono::steady_clock::now();
+    f();
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+    const size_t sheets = argc > 1 ? strtoul(argv[1], nullptr, 10) : 100000;
+    const size_t questionCount = 200;
+
+    Exam exam(1, "Benchmark", 120);
+    mt19937 rng(42);
+    vector<double> itemDifficulty(questionCount);
+    for (size_t i = 0; i < questionCount; ++i) {
+        exam.addQuestion(make_unique<MCQ>(static_cast<int>(i + 1), "Question " + to_string(i),
+                                          static_cast<int>(rng() % 4), vector<string>{"a", "b", "c", "d"}));
+        itemDifficulty[i] = normal_distribution<double>(0, 1)(rng);
+    }
+    shared_ptr<const AnswerKey> key = exam.getAnswerKey();
+
+    // Rasch-style responses: P(right) = 1 / (1 + e^(difficulty - ability)); ~3% blank
+    vector<uint8_t> packed(sheets * questionCount);
+    normal_distribution<double> ability(0, 1);
+    uniform_real_distribution<double> unit(0, 1);
+    for (size_t s = 0; s < sheets; ++s) {
+        double theta = ability(rng);
+        for (size_t i = 0; i < questionCount; ++i) {
+            uint8_t right = key->codes()[i];
+            double u = unit(rng);
+            uint8_t code;
+            if (u < 0.03) code = AnswerKey::UNANSWERED;
+            else if (unit(rng) < 1 / (1 + exp(itemDifficulty[i] - theta))) code = right;
+            else code = static_cast<uint8_t>((right + 1 + rng() % 3) % 4);
+            packed[s * questionCount + i] = code;
+        }
+    }
+
+    ExamStatistics statistics(exam);
+    statistics.reserve(sheets);
+    double ingestMs = timeMs([&] {
+        for (size_t s = 0; s < sheets; ++s) statistics.addPackedSheet(&packed[s * questionCount]);
+    });
+    ExamStatistics::ExamAnalysis analysis;
+    double analyzeMs = timeMs([&] { analysis = statistics.analyzeExam(); });
+
+    // Direct computation for comparison
+    vector<double> totals(sheets, 0), p(questionCount, 0);
+    for (size_t s = 0; s < sheets; ++s) {
+        for (size_t i = 0; i < questionCount; ++i) {
+            bool right = packed[s * questionCount + i] == key->codes()[i];
+            totals[s] += right;
+            p[i] += right;
+        }
+    }
+    double mean = 0, variance = 0, sumPQ = 0;
+    for (double t : totals) mean += t;
+    mean /= sheets;
+    for (double t : totals) variance += (t - mean) * (t - mean);
+    variance /= sheets;
+    double maxError = 0;
+    for (size_t i = 0; i < questionCount; ++i) {
+        p[i] /= sheets;
+        sumPQ += p[i] * (1 - p[i]);
+        maxError = max(maxError, fabs(p[i] - analysis.items[i].difficulty));
+    }
+    double kr20 = (double(questionCount) / (questionCount - 1)) * (1 - sumPQ / variance);
+    double minDiscrimination = 1;
+    for (const auto& item : analysis.items) minDiscrimination = min(minDiscrimination, item.discrimination);
+
+    cout << sheets << " sheets x " << questionCount << " questions\n";
+    cout << "  stream in (columnar): " << ingestMs << " ms\n";
+    cout << "  analyze:              " << analyzeMs << " ms\n";
+    cout << "  KR-20: " << analysis.reliability << " (direct " << kr20 << "), mean score " << analysis.meanScore
+         << ", lowest discrimination " << minDiscrimination << "\n";
+    bool agree = maxError < 1e-9 && fabs(kr20 - analysis.reliability) < 1e-6;
+    cout << "  results agree: " << (agree ? "yes" : "NO") << "\n";
+    return agree ? 0 : 1;
+}
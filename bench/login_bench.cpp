@@ -0,0 +1,83 @@
+// Benchmark: concurrent login throughput against the shared-locked UserManager.
+// Build with `make bench`, run ./bench/login_bench [userCount] [loginsPerThread]
+// Each run pits N reader threads calling authenticate() against one writer
+// that keeps renaming users, so the numbers include reader/writer contention.
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include "../24034.h"
+
+using namespace std;
+
+int main(int argc, char** argv) {
+    const int count = argc > 1 ? atoi(argv[1]) : 100000;
+    const int loginsPerThread = argc > 2 ? atoi(argv[2]) : 200000;
+
+    // Work in a scratch directory so the real users.json is never touched
+    filesystem::path dir = filesystem::temp_directory_path() / "login_bench";
+    filesystem::create_directories(dir);
+    filesystem::current_path(dir);
+
+    cout << "hardware threads: " << thread::hardware_concurrency() << "\n";
+    ostringstream sink;
+    streambuf* saved = cout.rdbuf(sink.rdbuf());
+    UserManager* manager = UserManager::getInstance();
+    stringstream csv;
+    for (int i = 0; i < count; ++i) {
+        csv << "Student " << i << ",Student,student" << i << ",pw" << i << "\n";
+    }
+    manager->importUsers(csv, UserManager::ImportFormat::CSV);
+    const int firstID = manager->getUserByUsername("student0")->getUserID();
+
+    for (int threads : {1, 2, 4, 8}) {
+        atomic<bool> stop{false};
+        atomic<long> accepted{0};
+        long renames = 0;
+
+        // Writer: exclusive lock per update, as an admin editing users would
+        thread writer([&] {
+            for (int i = 0; !stop.load(memory_order_relaxed); ++i) {
+                manager->updateUser(firstID + i % count, "Renamed " + to_string(i));
+                ++renames;
+                this_thread::sleep_for(chrono::microseconds(50));
+            }
+        });
+
+        auto start = chrono::steady_clock::now();
+        vector<thread> readers;
+        for (int t = 0; t < threads; ++t) {
+            readers.emplace_back([&, t] {
+                unsigned seed = 12345u + t;
+                long ok = 0;
+                int id;
+                Role role;
+                for (int i = 0; i < loginsPerThread; ++i) {
+                    seed = seed * 1103515245u + 12345u;
+                    int k = (seed >> 8) % count;
+                    string key = to_string(k);
+                    ok += manager->authenticate("student" + key, "pw" + key, id, role);
+                }
+                accepted += ok;
+            });
+        }
+        for (auto& r : readers) r.join();
+        double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        stop = true;
+        writer.join();
+
+        long total = static_cast<long>(threads) * loginsPerThread;
+        cout.rdbuf(saved);
+        cout << threads << " reader thread(s): " << total << " logins in " << ms << " ms ("
+             << static_cast<long>(total / (ms / 1000.0)) << " logins/s), "
+             << renames << " concurrent renames, " << (total - accepted) << " rejected\n";
+        cout.rdbuf(sink.rdbuf());
+    }
+    cout.rdbuf(saved);
+
+    filesystem::current_path(filesystem::temp_directory_path());
+    filesystem::remove_all(dir);
+    return 0;
+}
@@ -0,0 +1,87 @@
+// Benchmark: scheduling an exam week of 300 exams for 50k students.
+// Build with `make bench`, run ./bench/schedule_bench [studentCount]
+// 50 programmes each sit 5 core exams; every student also takes one of 50
+// electives, so each elective clashes with every programme. The bulk pass
+// places them into 15 periods (5 days x 3) across 30 halls and 10 small
+// rooms; the result is then checked for student and room clashes directly.
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include "../24043.h"
+
+using namespace std;
+
+template <typename F>
+static double timeMs(F&& f) {
+    auto start = chrono::steady_clock::now();
+    f();
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+    const size_t students = argc > 1 ? strtoul(argv[1], nullptr, 10) : 50000;
+    const int programmes = 50, coresEach = 5, electives = 50;
+
+    ExamScheduler scheduler;
+    for (int i = 0; i < 30; ++i) scheduler.addRoom("Hall " + to_string(i + 1), 1500);
+    for (int i = 0; i < 10; ++i) scheduler.addRoom("Room " + to_string(i + 1), 200);
+
+    mt19937 rng(42);
+    vector<ExamScheduler::WeekRequest> requests;
+    for (int i = 0; i < programmes * coresEach + electives; ++i)
+        requests.push_back({1000 + i, i % 2 ? 180 : 120, {}});
+    for (size_t s = 0; s < students; ++s) {
+        int programme = static_cast<int>(s % programmes);
+        for (int c = 0; c < coresEach; ++c) requests[programme * coresEach + c].cohort.push_back(static_cast<int>(s));
+        requests[programmes * coresEach + rng() % electives].cohort.push_back(static_cast<int>(s));
+    }
+
+    int64_t monday = 0;
+    ScheduleTime::parse("2026-06-01", monday);
+    vector<int64_t> periods;
+    for (int day = 0; day < 5; ++day)
+        for (int hour : {9, 13, 17}) periods.push_back(monday + day * 1440 + hour * 60);
+
+    ExamScheduler::WeekReport report;
+    double scheduleMs = timeMs([&] { report = scheduler.scheduleWeek(requests, periods); });
+
+    // Direct check: sort each student's windows and look for overlaps
+    bool clean = true;
+    double checkMs = timeMs([&] {
+        vector<vector<pair<int64_t, int64_t>>> perStudent(students);
+        map<string, vector<pair<int64_t, int64_t>>> perRoom;
+        for (const auto* slot : scheduler.timetable()) {
+            for (int s : slot->cohort) perStudent[s].push_back({slot->start, slot->end});
+            perRoom[slot->room].push_back({slot->start, slot->end});
+            if (slot->cohort.size() > static_cast<size_t>(scheduler.getRoomCapacity(slot->room))) clean = false;
+        }
+        auto overlapping = [](vector<pair<int64_t, int64_t>>& windows) {
+            sort(windows.begin(), windows.end());
+            for (size_t i = 1; i < windows.size(); ++i)
+                if (windows[i].first < windows[i - 1].second) return true;
+            return false;
+        };
+        for (auto& windows : perStudent) clean = clean && !overlapping(windows);
+        for (auto& [room, windows] : perRoom) clean = clean && !overlapping(windows);
+    });
+
+    // Single placement checks on a free Saturday morning: every cohort member's tree is queried
+    vector<ScheduleConflict> conflicts;
+    const ExamScheduler::Slot* first = scheduler.timetable().front();
+    int64_t saturday = monday + 5 * 1440 + 9 * 60;
+    size_t found = 0;
+    double probeMs = timeMs([&] {
+        for (int i = 0; i < 1000; ++i) {
+            conflicts.clear();
+            found += scheduler.findConflicts(-1, saturday, saturday + 180, first->room, first->cohort, conflicts);
+        }
+    });
+
+    cout << students << " students x " << requests.size() << " exams, " << periods.size() << " periods\n";
+    cout << "  scheduleWeek:    " << scheduleMs << " ms, " << report.scheduled << " scheduled, "
+         << report.unscheduled.size() << " left over, " << report.probes << " tree queries\n";
+    cout << "  findConflicts:   " << probeMs / 1000 << " ms per check (" << first->cohort.size() << " students)\n";
+    cout << "  direct re-check: " << checkMs << " ms, " << (clean ? "no clashes" : "CLASHES FOUND") << "\n";
+    return clean && found == 0 ? 0 : 1;
+}
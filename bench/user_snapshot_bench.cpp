@@ -0,0 +1,74 @@
+// Benchmark: cold start from users.bin (mmap) vs parsing users.json.
+// Build with `make bench`, run ./bench/user_snapshot_bench [userCount]
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include "../24034.h"
+
+using namespace std;
+
+template <typename F>
+static double timeMs(F&& f) {
+    auto start = chrono::steady_clock::now();
+    f();
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+    const int count = argc > 1 ? atoi(argv[1]) : 500000;
+
+    // Work in a scratch directory so the real users.json is never touched
+    filesystem::path dir = filesystem::temp_directory_path() / "user_snapshot_bench";
+    filesystem::create_directories(dir);
+    filesystem::current_path(dir);
+
+    ostringstream sink;
+    streambuf* saved = cout.rdbuf(sink.rdbuf());
+    UserManager* manager = UserManager::getInstance();
+    for (int i = 0; i < count; ++i) {
+        manager->registerUser("Student " + to_string(i), "Student", "student" + to_string(i), "pw" + to_string(i));
+    }
+    manager->saveUsersToFile();  // writes users.json and users.bin
+    cout.rdbuf(saved);
+
+    UserSnapshot snapshot;
+    double openMs = timeMs([&] { snapshot.open("users.bin"); });
+
+    const int lookups = 100000;
+    int found = 0;
+    double lookupMs = timeMs([&] {
+        UserSnapshot::UserView view;
+        string name;
+        for (int i = 0; i < lookups; ++i) {
+            name = "student" + to_string((i * 7919) % count);
+            if (snapshot.findByUsername(name, view)) ++found;
+        }
+    });
+
+    vector<User> table;
+    double materializeMs = timeMs([&] {
+        table.reserve(snapshot.size());
+        for (size_t i = 0; i < snapshot.size(); ++i) {
+            UserSnapshot::UserView v = snapshot.at(i);
+            table.push_back(User::restore(v.id, v.role, string(v.name), string(v.username), string(v.password)));
+        }
+    });
+
+    json parsed;
+    double jsonMs = timeMs([&] {
+        ifstream in("users.json");
+        in >> parsed;
+    });
+
+    cout << "users: " << count << " (users.bin " << filesystem::file_size("users.bin") / 1024
+         << " KiB, users.json " << filesystem::file_size("users.json") / 1024 << " KiB)\n\n";
+    cout << "mmap open + validate (ms)        " << openMs << "\n";
+    cout << lookups << " in-place lookups (ms)     " << lookupMs << " (" << found << " found)\n";
+    cout << "materialize User table (ms)      " << materializeMs << "\n";
+    cout << "users.json DOM parse only (ms)   " << jsonMs << "\n";
+
+    filesystem::current_path(dir.parent_path());
+    filesystem::remove_all(dir);
+    return 0;
+}
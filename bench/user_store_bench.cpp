@@ -0,0 +1,131 @@
+// Benchmark: legacy double-stored user list vs the single UserManager table.
+// Build with `make bench`, run ./bench/user_store_bench [userCount]
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <algorithm>
+#include "../24034.h"
+
+using namespace std;
+
+// ---- allocation accounting (live heap bytes) ----
+static size_t liveBytes = 0;
+
+void* operator new(size_t size) {
+    size_t* p = static_cast<size_t*>(malloc(size + sizeof(size_t)));
+    if (!p) throw bad_alloc();
+    *p = size;
+    liveBytes += size;
+    return p + 1;
+}
+
+void operator delete(void* ptr) noexcept {
+    if (!ptr) return;
+    size_t* p = static_cast<size_t*>(ptr) - 1;
+    liveBytes -= *p;
+    free(p);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    operator delete(ptr);
+}
+
+// ---- the layout UserManager used before: ListManager + users vector + shared_ptr indexes ----
+struct LegacyStore {
+    vector<shared_ptr<User>> listItems;
+    vector<shared_ptr<User>> users;
+    unordered_map<string, shared_ptr<User>> usernameIndex;
+    unordered_map<int, shared_ptr<User>> idIndex;
+
+    void registerUser(const string& name, const string& username, const string& password) {
+        auto u = make_shared<Student>(name, username, password);
+        listItems.push_back(u);
+        users.push_back(u);
+        usernameIndex[u->getUsername()] = u;
+        idIndex[u->getUserID()] = u;
+    }
+    void deleteUser(int id) {
+        auto found = idIndex.find(id);
+        if (found != idIndex.end()) {
+            usernameIndex.erase(found->second->getUsername());
+            idIndex.erase(found);
+        }
+        auto match = [id](shared_ptr<User> u) { return u->getUserID() == id; };
+        listItems.erase(remove_if(listItems.begin(), listItems.end(), match), listItems.end());
+        users.erase(remove_if(users.begin(), users.end(), match), users.end());
+    }
+    bool updateUser(int id) {
+        for (auto& user : listItems) {
+            if (user->getUserID() == id) {
+                for (auto& u : users) {
+                    if (u->getUserID() == id) return true;
+                }
+            }
+        }
+        return false;
+    }
+};
+
+template <typename F>
+static double timeMs(F&& f) {
+    auto start = chrono::steady_clock::now();
+    f();
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+    const int count = argc > 1 ? atoi(argv[1]) : 100000;
+    const int mutations = 1000;
+
+    // UserManager reports every action on stdout; silence it while measuring
+    ostringstream sink;
+    streambuf* saved = cout.rdbuf(sink.rdbuf());
+
+    size_t before = liveBytes;
+    LegacyStore legacy;
+    int firstLegacyID = 0;
+    double legacyRegister = timeMs([&] {
+        for (int i = 0; i < count; ++i) {
+            legacy.registerUser("Student " + to_string(i), "student" + to_string(i), "pw" + to_string(i));
+            if (i == 0) firstLegacyID = legacy.users.back()->getUserID();
+        }
+    });
+    size_t legacyBytes = liveBytes - before;
+    double legacyUpdate = timeMs([&] {
+        for (int i = 0; i < mutations; ++i) legacy.updateUser(firstLegacyID + count - 1 - i);
+    });
+    double legacyDelete = timeMs([&] {
+        for (int i = 0; i < mutations; ++i) legacy.deleteUser(firstLegacyID + i * (count / mutations));
+    });
+
+    UserManager* manager = UserManager::getInstance();
+    before = liveBytes;
+    int firstID = 0;
+    double tableRegister = timeMs([&] {
+        for (int i = 0; i < count; ++i) {
+            manager->registerUser("Student " + to_string(i), "Student", "student" + to_string(i), "pw" + to_string(i));
+            if (i == 0) firstID = manager->getAllUsers().back().getUserID();
+        }
+    });
+    size_t tableBytes = liveBytes - before;
+    double tableUpdate = timeMs([&] {
+        for (int i = 0; i < mutations; ++i) manager->updateUser(firstID + count - 1 - i, "Renamed");
+    });
+    double tableDelete = timeMs([&] {
+        for (int i = 0; i < mutations; ++i) manager->deleteUser(firstID + i * (count / mutations));
+    });
+
+    cout.rdbuf(saved);
+    cout << "users: " << count << ", updates/deletes: " << mutations << "\n\n";
+    cout << "                 legacy        table\n";
+    cout << "bytes/user       " << legacyBytes / count << "\t\t" << tableBytes / count << "\n";
+    cout << "  store overhead " << legacyBytes / count - sizeof(Student) << "\t\t"
+         << tableBytes / count - sizeof(Student) << "\t(excluding the " << sizeof(Student) << "-byte User object)\n";
+    cout << "register (ms)    " << legacyRegister << "\t\t" << tableRegister << "\n";
+    cout << "update (ms)      " << legacyUpdate << "\t\t" << tableUpdate << "\n";
+    cout << "delete (ms)      " << legacyDelete << "\t\t" << tableDelete << "\n";
+    return 0;
+}
@@ -0,0 +1,52 @@
+#ifndef BULK_IMPORT_H
+#define BULK_IMPORT_H
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Shared by the user and question importers
+
+// Outcome of a bulk import: invalid rows are reported and skipped, never fatal
+struct ImportReport {
+    struct RowError {
+        size_t line;
+        string reason;
+    };
+    size_t imported = 0;
+    int firstID = 0;    // imported records got the contiguous ids [firstID, lastID]
+    int lastID = -1;
+    vector<RowError> errors;
+};
+
+// Splits one CSV record; supports quoted fields with "" escapes
+inline bool parseCSVLine(const string& line, vector<string>& fields) {
+    fields.clear();
+    string field;
+    bool quoted = false;
+    for (size_t i = 0; i < line.size(); ++i) {
+        char c = line[i];
+        if (quoted) {
+            if (c == '"' && i + 1 < line.size() && line[i + 1] == '"') {
+                field += '"';
+                ++i;
+            } else if (c == '"') {
+                quoted = false;
+            } else {
+                field += c;
+            }
+        } else if (c == '"') {
+            quoted = true;
+        } else if (c == ',') {
+            fields.push_back(move(field));
+            field.clear();
+        } else if (c != '\r') {
+            field += c;
+        }
+    }
+    fields.push_back(move(field));
+    return !quoted;
+}
+
+#endif
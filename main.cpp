@@ -3,6 +3,7 @@
 #include <vector>
 #include <memory>
 #include <limits>
+#include <sstream>
 #include "24034.h" // User Management
 #include "24043.h" // Exam Management
 #include "24052.h" // Exam Session
@@ -25,34 +26,34 @@ void pressEnterToContinue() {
 
 // Global variables to track current user
 static int currentUserID = -1;
-static string currentUserRole = "";
+static Role currentUserRole = Role::Student;  // only meaningful while currentUserID != -1
+
+// Which roles may enter a module; checking one is a single bit test
+struct RoleRequirement {
+    uint8_t allowedRoles;
+    const char* label;
+};
+static const RoleRequirement ANY_ROLE = {roleBit(Role::Admin) | roleBit(Role::Teacher) | roleBit(Role::Student), "Any"};
+static const RoleRequirement ADMIN_OR_TEACHER = {roleBit(Role::Admin) | roleBit(Role::Teacher), "Admin/Teacher"};
+static const RoleRequirement TEACHER_ONLY = {roleBit(Role::Teacher), "Teacher"};
+static const RoleRequirement STUDENT_ONLY = {roleBit(Role::Student), "Student"};
 
 // Login function
 
-bool loginWithRoleCheck(const string& requiredRole) {
+bool loginWithRoleCheck(const RoleRequirement& required) {
     // If already logged in with appropriate role, no need to login again
-    if (currentUserID != -1) {
-        if (requiredRole == "Any" || 
-            (requiredRole == "Admin/Teacher" && (currentUserRole == "Admin" || currentUserRole == "Teacher")) ||
-            (requiredRole == "Teacher" && currentUserRole == "Teacher") ||
-            (requiredRole == "Student" && currentUserRole == "Student")) {
-            return true;
-        }
+    if (currentUserID != -1 && (required.allowedRoles & roleBit(currentUserRole))) {
+        return true;
     }
 
     UserManager* userManager = UserManager::getInstance();
     // Ensure users are loaded
     userManager->loadUsersFromFile();
     
-    // DEBUG: Print all users to verify they are loaded
-    cout << "\n[DEBUG] Available users in the system:" << endl;
-    int userCount = 0;
-    for (auto& user : userManager->getAllUsers()) {
-        cout << "  User ID: " << user->getUserID() 
-             << ", Username: " << user->getUsername() 
-             << ", Role: " << user->getRole() << endl;
-        userCount++;
-    }
+    // DEBUG: a count only; listing every user would build the whole table,
+    // while a login alone can be answered from the mapped users.bin
+    size_t userCount = userManager->getUserCount();
+    cout << "\n[DEBUG] Users in the system: " << userCount << endl;
     
     if (userCount == 0) {
         cout << "  [WARNING] No users found in the system! Please create a user first." << endl;
@@ -70,35 +71,30 @@ bool loginWithRoleCheck(const string& requiredRole) {
     // DEBUG: Print entered credentials
     cout << "[DEBUG] Attempting login with: Username=" << username << ", Password=" << password << endl;
     
-    // Find user in the user list
-    for (auto& user : userManager->getAllUsers()) {
-        if (user->getUsername() == username) {
-            cout << "[DEBUG] Username match found for: " << username << endl;
+    // Find user through the username index (a copy, safe against concurrent edits)
+    optional<User> user = userManager->getUserByUsername(username);
+    if (user) {
+        cout << "[DEBUG] Username match found for: " << username << endl;
+        
+        if (user->verifyPassword(password)) {
+            cout << "[DEBUG] Password verified successfully" << endl;
+            currentUserID = user->getUserID();
+            currentUserRole = user->getRole();
             
-            if (user->verifyPassword(password)) {
-                cout << "[DEBUG] Password verified successfully" << endl;
-                currentUserID = user->getUserID();
-                currentUserRole = user->getRole();
-                
-                if (requiredRole == "Any" || 
-                    (requiredRole == "Admin/Teacher" && (currentUserRole == "Admin" || currentUserRole == "Teacher"))) {
-                    cout << "Access granted. Welcome, " << username << "!" << endl;
-                    return true;
-                } else if (requiredRole == "Teacher" && currentUserRole == "Teacher") {
-                    cout << "Access granted. Welcome, Teacher " << username << "!" << endl;
-                    return true;
-                } else if (requiredRole == "Student" && currentUserRole == "Student") {
-                    cout << "Access granted. Welcome, Student " << username << "!" << endl;
-                    return true;
-                } else {
-                    cout << "Access denied. This module requires " << requiredRole << " privileges." << endl;
-                    currentUserID = -1;
-                    currentUserRole = "";
-                    return false;
+            if (required.allowedRoles & roleBit(currentUserRole)) {
+                cout << "Access granted. Welcome, ";
+                if (required.allowedRoles == roleBit(currentUserRole)) {
+                    cout << roleName(currentUserRole) << " ";
                 }
+                cout << username << "!" << endl;
+                return true;
             } else {
-                cout << "[DEBUG] Password verification failed" << endl;
+                cout << "Access denied. This module requires " << required.label << " privileges." << endl;
+                currentUserID = -1;
+                return false;
             }
+        } else {
+            cout << "[DEBUG] Password verification failed" << endl;
         }
     }
     
@@ -109,12 +105,12 @@ bool loginWithRoleCheck(const string& requiredRole) {
 // Login function (for main menu)
 void loginUser() {
     if (currentUserID != -1) {
-        cout << "You are already logged in as " << currentUserRole << " (ID: " << currentUserID << ")" << endl;
+        cout << "You are already logged in as " << roleName(currentUserRole) << " (ID: " << currentUserID << ")" << endl;
         pressEnterToContinue();
         return;
     }
     
-    loginWithRoleCheck("Any");
+    loginWithRoleCheck(ANY_ROLE);
     pressEnterToContinue();
 }
 
@@ -125,7 +121,6 @@ void logoutUser() {
     } else {
         cout << "Logging out..." << endl;
         currentUserID = -1;
-        currentUserRole = "";
         cout << "Logged out successfully." << endl;
     }
     pressEnterToContinue();
@@ -144,7 +139,7 @@ void userManagementMenu() {
         
         // Display logged-in status if someone is logged in
         if (currentUserID != -1) {
-            cout << "Logged in as: " << currentUserRole << " (ID: " << currentUserID << ")" << endl;
+            cout << "Logged in as: " << roleName(currentUserRole) << " (ID: " << currentUserID << ")" << endl;
         } else {
             cout << "No user logged in. You can create users before logging in." << endl;
         }
@@ -153,7 +148,9 @@ void userManagementMenu() {
         cout << "2. Update User" << endl;
         cout << "3. Delete User" << endl;
         cout << "4. Display All Users" << endl;
-        cout << "5. Back to Main Menu" << endl;
+        cout << "5. Bulk Import Users (CSV/JSONL)" << endl;
+        cout << "6. Search Users" << endl;
+        cout << "7. Back to Main Menu" << endl;
         cout << "Enter your choice: ";
 
         int choice;
@@ -172,9 +169,10 @@ void userManagementMenu() {
                 cout << "Enter password: ";
                 getline(cin, password);
                 
-                userManager->registerUser(name, role, username, password);
-                userManager->saveUsersToFile();
-                cout << "User registered successfully." << endl;
+                // Persisted as one journal append; no full users.json rewrite
+                if (userManager->registerUser(name, role, username, password)) {
+                    cout << "User registered successfully." << endl;
+                }
                 pressEnterToContinue();
                 break;
             }
@@ -188,7 +186,6 @@ void userManagementMenu() {
                 getline(cin, newName);
                 
                 userManager->updateUser(userID, newName);
-                userManager->saveUsersToFile();
                 pressEnterToContinue();
                 break;
             }
@@ -198,7 +195,6 @@ void userManagementMenu() {
                 cin >> userID;
                 
                 userManager->deleteUser(userID);
-                userManager->saveUsersToFile();
                 pressEnterToContinue();
                 break;
             }
@@ -208,7 +204,56 @@ void userManagementMenu() {
                 break;
             }
             case 5: {
-                userManager->saveUsersToFile();
+                string path;
+                cout << "Enter file path (.csv or .jsonl): ";
+                cin.ignore();
+                getline(cin, path);
+                
+                UserImportReport report = userManager->importUsersFromFile(path);
+                cout << "Imported " << report.imported << " users";
+                if (report.imported > 0) {
+                    cout << " (IDs " << report.firstID << "-" << report.lastID << ")";
+                }
+                cout << ", " << report.errors.size() << " rows rejected." << endl;
+                size_t shown = 0;
+                for (const auto& error : report.errors) {
+                    if (++shown > 20) {
+                        cout << "  ... " << report.errors.size() - 20 << " more" << endl;
+                        break;
+                    }
+                    cout << "  Line " << error.line << ": " << error.reason << endl;
+                }
+                pressEnterToContinue();
+                break;
+            }
+            case 6: {
+                string query, more;
+                cout << "Enter part of a name or username: ";
+                cin.ignore();
+                getline(cin, query);
+
+                const size_t pageSize = 20;
+                size_t offset = 0;
+                while (true) {
+                    UserSearchPage page = userManager->searchUsers(query, offset, pageSize);
+                    if (page.users.empty()) {
+                        cout << (offset == 0 ? "No matching users." : "No more matches.") << endl;
+                        break;
+                    }
+                    cout << "Matches " << offset + 1 << "-" << offset + page.users.size() << ":" << endl;
+                    for (const User& user : page.users) {
+                        user.displayDetails();
+                    }
+                    if (!page.hasMore) break;
+                    cout << "Enter 'n' for the next page, anything else to stop: ";
+                    getline(cin, more);
+                    if (more != "n" && more != "N") break;
+                    offset += pageSize;
+                }
+                pressEnterToContinue();
+                break;
+            }
+            case 7: {
                 return;
             }
             default: {
@@ -225,7 +270,7 @@ void examManagementMenu() {
     examManager->loadExamsFromFile();
 
     // Check login and role
-    if (!loginWithRoleCheck("Admin/Teacher")) {
+    if (!loginWithRoleCheck(ADMIN_OR_TEACHER)) {
         pressEnterToContinue();
         return;
     }
@@ -233,7 +278,7 @@ void examManagementMenu() {
     while (true) {
         clearScreen();
         cout << "=== EXAM MANAGEMENT ===" << endl;
-        cout << "Logged in as: " << currentUserRole << " (ID: " << currentUserID << ")" << endl;
+        cout << "Logged in as: " << roleName(currentUserRole) << " (ID: " << currentUserID << ")" << endl;
         cout << "1. Create Exam" << endl;
         cout << "2. Add Question to Exam" << endl;
         cout << "3. Modify Question" << endl;
@@ -241,11 +286,20 @@ void examManagementMenu() {
         cout << "5. Delete Exam" << endl;
         cout << "6. Display Exam" << endl;
         cout << "7. Display All Exams" << endl;
-        cout << "8. Back to Main Menu" << endl;
+        cout << "8. Enroll Students in Exam" << endl;
+        cout << "9. View Enrollment Status" << endl;
+        cout << "10. Per-Student Variants" << endl;
+        cout << "11. Import Questions from File" << endl;
+        cout << "12. Search Question Bank" << endl;
+        cout << "13. Near-Duplicate Questions" << endl;
+        cout << "14. Add Exam Room" << endl;
+        cout << "15. Schedule Exam" << endl;
+        cout << "16. View Timetable" << endl;
+        cout << "17. Back to Main Menu" << endl;
         cout << "Enter your choice: ";
 
         int choice;
-        cin >> choice;
+        if (!(cin >> choice)) choice = 17;  // input closed: save and leave
 
         switch (choice) {
             case 1: {
@@ -259,7 +313,6 @@ void examManagementMenu() {
                 
                 int examID = examManager->createExam(subject, duration);
                 cout << "Exam created with ID: " << examID << endl;
-                examManager->saveExamsToFile();
                 pressEnterToContinue();
                 break;
             }
@@ -271,14 +324,17 @@ void examManagementMenu() {
                 cout << "Enter question text: ";
                 cin.ignore();
                 getline(cin, questionText);
-                cout << "Enter question type (MCQ/Descriptive): ";
+                cout << "Enter question type (MCQ/Descriptive/TrueFalse/MultiSelect/Numeric): ";
                 getline(cin, type);
-                cout << "Enter correct answer: ";
+                cout << "Enter correct answer (option letter(s) for MCQ/MultiSelect, true/false, or a number): ";
                 getline(cin, answer);
                 
-                int qID = examManager->addQuestion(examID, questionText, type, answer);
-                cout << "Question added with ID: " << qID << endl;
-                examManager->saveExamsToFile();
+                try {
+                    int qID = examManager->addQuestion(examID, questionText, type, answer);
+                    cout << "Question added with ID: " << qID << endl;
+                } catch (const ExamException& e) {
+                    cout << "Error: " << e.what() << endl;
+                }
                 pressEnterToContinue();
                 break;
             }
@@ -294,7 +350,6 @@ void examManagementMenu() {
                 getline(cin, newText);
                 
                 examManager->modifyQuestion(examID, questionID, newText);
-                examManager->saveExamsToFile();
                 pressEnterToContinue();
                 break;
             }
@@ -306,7 +361,6 @@ void examManagementMenu() {
                 cin >> questionID;
                 
                 examManager->removeQuestion(examID, questionID);
-                examManager->saveExamsToFile();
                 pressEnterToContinue();
                 break;
             }
@@ -316,7 +370,8 @@ void examManagementMenu() {
                 cin >> examID;
                 
                 examManager->deleteExam(examID);
-                examManager->saveExamsToFile();
+                EnrollmentManager::getInstance()->removeExam(examID);
+                EnrollmentManager::getInstance()->saveToFile();
                 pressEnterToContinue();
                 break;
             }
@@ -331,13 +386,222 @@ void examManagementMenu() {
             }
             case 7: {
                 examManager->displayAllExams();
+                cout << "Exam cache: " << examManager->getCachedExamCount() << " loaded, "
+                     << examManager->getCacheHits() << " hits, " << examManager->getCacheMisses() << " misses" << endl;
                 pressEnterToContinue();
                 break;
             }
             case 8: {
+                int examID;
+                string line;
+                cout << "Enter Exam ID: ";
+                cin >> examID;
+                cout << "Enter student IDs or ranges (e.g. 101 105 200-299): ";
+                cin.ignore();
+                getline(cin, line);
+
+                // Ranges go straight into the bitmap; each one is capped so a typo
+                // like 1-2000000000 cannot enroll (or allocate for) billions of ids
+                const int maxRangeSize = 100000;
+                IdBitmap studentIDs;
+                istringstream tokens(line);
+                string token;
+                while (tokens >> token) {
+                    try {
+                        size_t dash = token.find('-');
+                        int first = stoi(token.substr(0, dash));
+                        int last = dash == string::npos ? first : stoi(token.substr(dash + 1));
+                        if (first < 1 || last < first) {
+                            cout << "Skipping invalid entry '" << token << "'" << endl;
+                        } else if (int64_t(last) - first >= maxRangeSize) {
+                            cout << "Skipping range '" << token << "': more than " << maxRangeSize << " IDs" << endl;
+                        } else {
+                            studentIDs.addRange(first, last);
+                        }
+                    } catch (const exception&) {
+                        cout << "Skipping invalid entry '" << token << "'" << endl;
+                    }
+                }
+
+                EnrollmentManager* enrollment = EnrollmentManager::getInstance();
+                size_t added = enrollment->enrollMany(examID, studentIDs);
+                enrollment->saveToFile();
+                cout << added << " student(s) newly enrolled in exam " << examID << endl;
+                pressEnterToContinue();
+                break;
+            }
+            case 9: {
+                int examID;
+                cout << "Enter Exam ID: ";
+                cin >> examID;
+
+                EnrollmentManager::getInstance()->displayEnrollmentStatus(examID);
+                pressEnterToContinue();
+                break;
+            }
+            case 10: {
+                int examID, drawCount = 0;
+                char enable;
+                cout << "Enter Exam ID: ";
+                cin >> examID;
+                cout << "Give each student shuffled questions and options? (y/n): ";
+                cin >> enable;
+                bool enabled = enable == 'y' || enable == 'Y';
+                if (enabled) {
+                    cout << "Questions per student (0 = all): ";
+                    cin >> drawCount;
+                }
+
+                try {
+                    examManager->setRandomization(examID, enabled, drawCount);
+                    cout << (enabled ? "Per-student variants enabled." : "Variants disabled.") << endl;
+                } catch (const ExamException& e) {
+                    cout << "Error: " << e.what() << endl;
+                }
+                pressEnterToContinue();
+                break;
+            }
+            case 11: {
+                int examID;
+                string path;
+                cout << "Enter Exam ID: ";
+                cin >> examID;
+                cout << "Enter file path (.csv or .jsonl): ";
+                cin.ignore();
+                getline(cin, path);
+
+                try {
+                    QuestionImportReport report = examManager->importQuestionsFromFile(examID, path);
+                    cout << "Imported " << report.imported << " questions";
+                    if (report.imported > 0) {
+                        cout << " (IDs " << report.firstID << "-" << report.lastID << ")";
+                    }
+                    cout << ", " << report.errors.size() << " rows rejected." << endl;
+                    size_t shown = 0;
+                    for (const auto& error : report.errors) {
+                        if (++shown > 20) {
+                            cout << "  ... " << report.errors.size() - 20 << " more" << endl;
+                            break;
+                        }
+                        cout << "  Line " << error.line << ": " << error.reason << endl;
+                    }
+                } catch (const ExamException& e) {
+                    cout << "Error: " << e.what() << endl;
+                }
+                pressEnterToContinue();
+                break;
+            }
+            case 12: {
+                string query;
+                cout << "Enter search words: ";
+                cin.ignore();
+                getline(cin, query);
+
+                vector<QuestionIndex::Hit> hits;
+                size_t total = examManager->searchQuestions(query, hits);
+                cout << total << " matching question(s)" << endl;
+                for (const auto& hit : hits) {
+                    shared_ptr<const Question> question = examManager->getQuestion(hit.examID, hit.questionID);
+                    cout << "  Exam " << hit.examID << ", Q" << hit.questionID << ": "
+                         << (question ? question->getQuestionText() : "") << endl;
+                }
+                if (total > hits.size()) cout << "  ... " << total - hits.size() << " more" << endl;
+                pressEnterToContinue();
+                break;
+            }
+            case 13: {
+                double threshold;
+                cout << "Minimum similarity (0.4-1.0, e.g. 0.8): ";
+                cin >> threshold;
+                if (!(threshold >= 0.4 && threshold <= 1)) threshold = 0.8;
+
+                auto pairs = examManager->findNearDuplicates(threshold);
+                cout << pairs.size() << " near-duplicate pair(s)" << endl;
+                for (const auto& pair : pairs) {
+                    auto first = examManager->getQuestion(pair.first.examID, pair.first.questionID);
+                    auto second = examManager->getQuestion(pair.second.examID, pair.second.questionID);
+                    cout << fixed << setprecision(2) << "  " << pair.similarity << "  Exam "
+                         << pair.first.examID << " Q" << pair.first.questionID << " / Exam "
+                         << pair.second.examID << " Q" << pair.second.questionID << endl;
+                    cout.unsetf(ios::floatfield);
+                    if (first) cout << "      " << first->getQuestionText() << endl;
+                    if (second) cout << "      " << second->getQuestionText() << endl;
+                }
+                pressEnterToContinue();
+                break;
+            }
+            case 14: {
+                string room;
+                int capacity;
+                cout << "Enter room name: ";
+                cin.ignore();
+                getline(cin, room);
+                cout << "Enter capacity: ";
+                cin >> capacity;
+                try {
+                    examManager->addRoom(room, capacity);
+                    cout << "Room " << room << " added." << endl;
+                } catch (const ExamException& e) {
+                    cout << "Error: " << e.what() << endl;
+                }
+                pressEnterToContinue();
+                break;
+            }
+            case 15: {
+                int examID;
+                string startText, room;
+                cout << "Enter Exam ID: ";
+                cin >> examID;
+                cout << "Enter start (YYYY-MM-DD HH:MM): ";
+                cin.ignore();
+                getline(cin, startText);
+                cout << "Enter room name: ";
+                getline(cin, room);
+
+                int64_t start;
+                if (!ScheduleTime::parse(startText, start)) {
+                    cout << "Invalid start time." << endl;
+                    pressEnterToContinue();
+                    break;
+                }
+                // The cohort is the exam's enrollment roster
+                vector<int> cohort = EnrollmentManager::getInstance()->getEnrolled(examID).toVector();
+                vector<ScheduleConflict> conflicts;
+                try {
+                    if (examManager->scheduleExam(examID, start, room, cohort, conflicts)) {
+                        cout << "Exam " << examID << " scheduled for " << cohort.size() << " student(s)." << endl;
+                    } else {
+                        cout << "Cannot schedule exam " << examID << ":" << endl;
+                        for (const auto& conflict : conflicts) cout << "  " << conflict.describe() << endl;
+                    }
+                } catch (const ExamException& e) {
+                    cout << "Error: " << e.what() << endl;
+                }
+                pressEnterToContinue();
+                break;
+            }
+            case 16: {
+                int studentID;
+                cout << "Enter Student ID (0 for all exams): ";
+                cin >> studentID;
+
+                const ExamScheduler& scheduler = examManager->getScheduler();
+                auto slots = studentID ? scheduler.timetableFor(studentID) : scheduler.timetable();
+                if (slots.empty()) cout << "Nothing scheduled." << endl;
+                for (const auto* slot : slots) {
+                    cout << ScheduleTime::format(slot->start) << " - " << ScheduleTime::format(slot->end).substr(11)
+                         << "  Exam " << slot->examID << "  Room " << slot->room
+                         << "  (" << slot->cohort.size() << " students)" << endl;
+                }
+                pressEnterToContinue();
+                break;
+            }
+            case 17: {
+                // Edits above only mark exams (and the timetable) dirty; the
+                // burst is written here in one pass (ExamManager also saves
+                // every AUTOSAVE_EDITS edits on its own)
                 examManager->saveExamsToFile();
                 currentUserID = -1;
-                currentUserRole = "";
                 return;
             }
             default: {
@@ -355,7 +619,7 @@ void examSessionMenu() {
     examManager->loadExamsFromFile();
 
     // Check login and role
-    if (!loginWithRoleCheck("Student")) {
+    if (!loginWithRoleCheck(STUDENT_ONLY)) {
         pressEnterToContinue();
         return;
     }
@@ -370,7 +634,8 @@ void examSessionMenu() {
         cout << "5. Finish Exam" << endl;
         cout << "6. View Exam Results" << endl;
         cout << "7. Display Active Sessions" << endl;
-        cout << "8. Back to Main Menu" << endl;
+        cout << "8. Discard Unfinished Session" << endl;
+        cout << "9. Back to Main Menu" << endl;
         cout << "Enter your choice: ";
 
         int choice;
@@ -397,7 +662,7 @@ void examSessionMenu() {
                 cin >> examID;
                 cout << "Enter Question ID: ";
                 cin >> questionID;
-                cout << "Enter your answer: ";
+                cout << "Enter your answer (option letter for MCQ): ";
                 cin.ignore();
                 getline(cin, answer);
                 
@@ -475,6 +740,17 @@ void examSessionMenu() {
                 break;
             }
             case 8: {
+                int studentID, examID;
+                cout << "Enter Student ID: ";
+                cin >> studentID;
+                cout << "Enter Exam ID: ";
+                cin >> examID;
+                
+                sessionManager->discardSession(studentID, examID);
+                pressEnterToContinue();
+                break;
+            }
+            case 9: {
                 sessionManager->saveAllSessions();
                 return;
             }
@@ -492,7 +768,7 @@ void gradingSystemMenu() {
     ExamGrader examGrader;
 
     // Check login and role
-    if (!loginWithRoleCheck("Teacher")) {
+    if (!loginWithRoleCheck(TEACHER_ONLY)) {
         pressEnterToContinue();
         return;
     }
@@ -614,7 +890,7 @@ void reminderManagementMenu() {
     ReminderManager* reminderManager = ReminderManager::getInstance();
 
     // Check login and role
-    if (!loginWithRoleCheck("Student")) {
+    if (!loginWithRoleCheck(STUDENT_ONLY)) {
         pressEnterToContinue();
         return;
     }
@@ -723,7 +999,6 @@ void reminderManagementMenu() {
                     cout << "Error saving reminders: " << e.what() << endl;
                 }
                 currentUserID = -1;
-                currentUserRole = "";
                 return;
             }
             default: {
@@ -744,6 +1019,8 @@ int main() {
     examManager->loadExamsFromFile();
     
     SessionManager* sessionManager = SessionManager::getInstance();
+    EnrollmentManager* enrollmentManager = EnrollmentManager::getInstance();
+    enrollmentManager->loadFromFile();
     
     GradingSystem<shared_ptr<Result>>* gradingSystem = GradingSystem<shared_ptr<Result>>::getInstance();
     
@@ -759,7 +1036,7 @@ int main() {
         clearScreen();
         cout << "=== EXAM MANAGEMENT SYSTEM ===" << endl;
         if (currentUserID != -1) {
-            cout << "Logged in as: " << currentUserRole << " (ID: " << currentUserID << ")" << endl;
+            cout << "Logged in as: " << roleName(currentUserRole) << " (ID: " << currentUserID << ")" << endl;
         } else {
             cout << "No user logged in" << endl;
         }
@@ -776,7 +1053,7 @@ int main() {
         cout << "Enter your choice: ";
 
         int choice;
-        cin >> choice;
+        if (!(cin >> choice)) choice = 8;  // input closed: save everything and exit
 
         switch (choice) {
             case 1:
@@ -805,6 +1082,7 @@ int main() {
                 userManager->saveUsersToFile();
                 examManager->saveExamsToFile();
                 sessionManager->saveAllSessions();
+                enrollmentManager->saveToFile();
                 try {
                     reminderManager->saveToFile();
                 } catch (const ReminderException& e) {
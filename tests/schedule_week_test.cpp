@@ -0,0 +1,45 @@
+// Test: scheduleWeek keeps an exam's existing slot when it cannot be placed.
+// Build and run with `make test`
+// Exam 1 is booked Monday 09:00 for 5 students. A week pass then asks for it
+// with 20 students, more than any room holds: it must stay unscheduled by the
+// pass and still own its Monday slot. Exam 2 in the same pass fits and moves.
+#include <iostream>
+#include "../24043.h"
+
+using namespace std;
+
+static int fail(const string& what) {
+    cerr << "FAIL: " << what << endl;
+    return 1;
+}
+
+int main() {
+    ExamScheduler scheduler;
+    scheduler.addRoom("Hall", 10);
+
+    int64_t monday = 0;
+    ScheduleTime::parse("2026-06-01 09:00", monday);
+    vector<ScheduleConflict> conflicts;
+    if (!scheduler.schedule(1, monday, monday + 120, "Hall", {1, 2, 3, 4, 5}, conflicts))
+        return fail("initial booking of exam 1");
+    if (!scheduler.schedule(2, monday + 1440, monday + 1440 + 60, "Hall", {6, 7}, conflicts))
+        return fail("initial booking of exam 2");
+
+    vector<int> tooMany;
+    for (int s = 1; s <= 20; ++s) tooMany.push_back(s);
+    vector<ExamScheduler::WeekRequest> requests = {{1, 120, tooMany}, {2, 60, {6, 7}}};
+    vector<int64_t> periods = {monday + 2 * 1440, monday + 3 * 1440};
+    ExamScheduler::WeekReport report = scheduler.scheduleWeek(requests, periods);
+
+    if (report.scheduled != 1 || report.unscheduled != vector<int>{1})
+        return fail("expected exam 2 placed and exam 1 left over");
+    const ExamScheduler::Slot* kept = scheduler.getSlot(1);
+    if (!kept || kept->start != monday || kept->room != "Hall" || kept->cohort.size() != 5)
+        return fail("exam 1 lost its original slot");
+    if (scheduler.timetableFor(3).size() != 1) return fail("exam 1's students lost their booking");
+    const ExamScheduler::Slot* moved = scheduler.getSlot(2);
+    if (!moved || moved->start != periods[0]) return fail("exam 2 was not moved to the first period");
+
+    cout << "schedule_week_test: OK" << endl;
+    return 0;
+}
@@ -0,0 +1,75 @@
+// Test: a session saved by one run and started again by the next holds one pin.
+// Build and run with `make test`
+// Each phase runs as its own process (this binary re-invoked with the phase
+// name), so the singletons start empty exactly as after a restart:
+//   start   - create an exam, start student 7 on it and save
+//   restart - start student 7 again; the saved session is resumed, one pin
+//   reopen  - a third run reads the saved pins back; still one
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include "../24052.h"
+
+using namespace std;
+
+static const int STUDENT = 7;
+
+static int fail(const string& what) {
+    cerr << "FAIL: " << what << endl;
+    return 1;
+}
+
+static int pinCount(int examID) {
+    ExamSession* session = SessionManager::getInstance()->getSession(STUDENT, examID);
+    if (!session) return -1;
+    return ExamManager::getInstance()->getPinCount(examID, session->getExamVersion());
+}
+
+static int runPhase(const string& phase) {
+    ExamManager* exams = ExamManager::getInstance();
+    SessionManager* sessions = SessionManager::getInstance();
+    exams->loadExamsFromFile();
+    const int examID = 1000;
+
+    if (phase == "start") {
+        int created = exams->createExam("Pins", 60);
+        if (created != examID) return fail("expected exam " + to_string(examID) + ", got " + to_string(created));
+        exams->addMCQuestion(examID, "2 + 2", 1, {"3", "4", "5"});
+        exams->saveExamsToFile();
+        sessions->startSession(STUDENT, examID);
+        sessions->saveAllSessions();
+        return pinCount(examID) == 1 ? 0 : fail("first start: pin count " + to_string(pinCount(examID)));
+    }
+    if (phase == "restart") {
+        sessions->startSession(STUDENT, examID);
+        if (pinCount(examID) != 1) return fail("after restart: pin count " + to_string(pinCount(examID)));
+        exams->saveExamsToFile();
+        error_code ec;
+        if (filesystem::file_size("exams/pins.log", ec) != 0) return fail("pins.log not emptied by save");
+        return 0;
+    }
+    if (phase == "reopen") {
+        return pinCount(examID) == 1 ? 0 : fail("after reopen: pin count " + to_string(pinCount(examID)));
+    }
+    return fail("unknown phase " + phase);
+}
+
+int main(int argc, char** argv) {
+    if (argc > 2) {
+        filesystem::current_path(argv[2]);
+        return runPhase(argv[1]);
+    }
+
+    filesystem::path dir = filesystem::temp_directory_path() / "session_pin_test";
+    filesystem::remove_all(dir);
+    filesystem::create_directories(dir);
+    string self = filesystem::absolute(argv[0]).string();
+    for (const char* phase : {"start", "restart", "reopen"}) {
+        string command = "\"" + self + "\" " + phase + " \"" + dir.string() + "\" > /dev/null";
+        if (system(command.c_str()) != 0) return fail(string("phase ") + phase);
+    }
+    filesystem::remove_all(dir);
+    cout << "session_pin_test: OK" << endl;
+    return 0;
+}